@@ -28,11 +28,22 @@
 
 #define MAX_COMMAND_TIME         (5000/10)               // Trigger and command must be spoke in 5000 ms (500 frames).
 #define DSPOTTER_FRAME_SAMPLE    480                     // DSpotter compute every 30 ms, it is 480 samples or 16 KHz.
+#define MAX_COMMAND_SAMPLES      (MAX_COMMAND_TIME * 160)  // MAX_COMMAND_TIME in samples at 16 KHz.
 #define COMMAND_STAGE_TIMEOUT    appconfINTENT_RESET_DELAY_MS  // When no result at command recognition stage, the minimum recording time in ms.
 #define VOLUME_SCALE_RECONG      800                     // The AGC volume scale percentage for recognition. It depends on original microphone data.
 
-static uint8_t *g_lpbyDSpotterMem = NULL;
-static size_t g_nRecordFrameCount = 0;
+typedef struct dspotter_asr_struct
+{
+    uint8_t *lpbyDSpotterMem;
+    int nMemSize;
+    size_t nRecordFrameCount;
+    uint32_t nSampleCount;      // Samples given to DSpotter since asr_init, modulo 2^31 (37 hours at 16 KHz)
+    uint32_t nResultEndIndex;   // nSampleCount when the last result was recognized
+    int bSampleCountWrapped;    // nSampleCount has wrapped at least once
+} dspotter_asr_t;
+
+// DSpotterHL keeps its state in the library, so only one instance can be in use
+static dspotter_asr_t *g_lpInstance = NULL;
 devmem_manager_t *devmem_ctx = NULL;
 
 
@@ -48,6 +59,7 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
     int nCount;
     int nMemSize;
     int nRet;
+    dspotter_asr_t *lpAsr;
 
     DBG_TRACE("App build at %s, %s\r\n", __DATE__, __TIME__);
     DBG_TRACE("DSpotter version %s\r\n", DSpotterHL_GetVer());
@@ -57,8 +69,25 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
     DBG_TRACE("\r\n");
 #endif
 
+    if (g_lpInstance != NULL)
+    {
+        DBG_TRACE("DSpotter supports one instance, and it is in use!\r\n");
+        return NULL;
+    }
+
     devmem_ctx = devmem;
 
+    lpAsr = devmem_malloc(devmem_ctx, sizeof(dspotter_asr_t));
+    if (lpAsr == NULL)
+    {
+        DBG_TRACE("devmem_malloc() fail!\r\n");
+        return NULL;
+    }
+    lpAsr->nRecordFrameCount = 0;
+    lpAsr->nSampleCount = 0;
+    lpAsr->nResultEndIndex = 0;
+    lpAsr->bSampleCountWrapped = 0;
+
     oDSpotterInitData.nInitDataVer = DSPOTTER_INIT_DATA_VER;
     oDSpotterInitData.nInitDataSize = (uint8_t)sizeof(DSpotterInitData);
     oDSpotterInitData.nMaxCommandTime = MAX_COMMAND_TIME;
@@ -70,20 +99,22 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
 
     nMemSize = DSpotterHL_GetMemoryUsage((const uint32_t *)model, &oDSpotterInitData);
     DBG_TRACE("The DSpotter memory usage is %d.\r\n", nMemSize);
-    g_lpbyDSpotterMem = devmem_malloc(devmem_ctx, nMemSize);
-    if (g_lpbyDSpotterMem == NULL)
+    lpAsr->nMemSize = nMemSize;
+    lpAsr->lpbyDSpotterMem = devmem_malloc(devmem_ctx, nMemSize);
+    if (lpAsr->lpbyDSpotterMem == NULL)
     {
         DBG_TRACE("devmem_malloc() fail!\r\n");
+        devmem_free(devmem_ctx, lpAsr);
         return NULL;
     }
 
     DBG_TRACE("DSpotterHL_Init\r\n");
-    nRet = DSpotterHL_Init((const uint32_t *)model, &oDSpotterInitData, g_lpbyDSpotterMem, nMemSize);
+    nRet = DSpotterHL_Init((const uint32_t *)model, &oDSpotterInitData, lpAsr->lpbyDSpotterMem, nMemSize);
     if (nRet != DSPOTTER_SUCCESS)
     {
         DBG_TRACE("DSpotterHL_Init() fail, error = %d!\r\n", nRet);
-        devmem_free(devmem_ctx, g_lpbyDSpotterMem);
-        g_lpbyDSpotterMem = NULL;
+        devmem_free(devmem_ctx, lpAsr->lpbyDSpotterMem);
+        devmem_free(devmem_ctx, lpAsr);
         return NULL;
     }
 
@@ -107,16 +138,32 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
     }
     DBG_TRACE("\r\n");
 
-    return (asr_port_t)100;
+    g_lpInstance = lpAsr;
+    return (asr_port_t)lpAsr;
 }
 
 asr_error_t asr_get_attributes(asr_port_t *ctx, asr_attributes_t *attributes)
 {
-    return ASR_NOT_SUPPORTED;
+    dspotter_asr_t *lpAsr = (dspotter_asr_t *)ctx;
+
+    xassert(lpAsr == g_lpInstance);
+    xassert(attributes);
+
+    memset(attributes, 0, sizeof(asr_attributes_t));
+    attributes->samples_per_brick = DSPOTTER_FRAME_SAMPLE;
+    strncpy(attributes->engine_version, DSpotterHL_GetVer(), sizeof(attributes->engine_version) - 1);
+    // The model version is not available from DSpotterHL
+    attributes->required_memory = sizeof(dspotter_asr_t) + lpAsr->nMemSize;
+    attributes->max_instances = 1;
+    return ASR_OK;
 }
 
 asr_error_t asr_process(asr_port_t *ctx, int16_t *audio_buf, size_t buf_len)
 {
+    dspotter_asr_t *lpAsr = (dspotter_asr_t *)ctx;
+
+    xassert(lpAsr == g_lpInstance);
+
 #ifdef UART_DUMP_RECORD
     uint8_t byaTxBuffer[DSPOTTER_FRAME_SAMPLE*sizeof(int16_t)*3/2];
     int nTransferSize;
@@ -127,11 +174,19 @@ asr_error_t asr_process(asr_port_t *ctx, int16_t *audio_buf, size_t buf_len)
         rtos_uart_tx_write(uart_tx_ctx, byaTxBuffer, (uint32_t)nTransferSize);
     }
 #else
-    if (++g_nRecordFrameCount % 100 == 0) {
+    if (++lpAsr->nRecordFrameCount % 100 == 0) {
         DBG_TRACE(".");
     }
 #endif
 
+    // Kept within the int32_t sample indices of asr_result_t, which wrap with it
+    lpAsr->nSampleCount += buf_len;
+    if (lpAsr->nSampleCount > INT32_MAX)
+    {
+        lpAsr->nSampleCount &= INT32_MAX;
+        lpAsr->bSampleCountWrapped = 1;
+    }
+
 #ifdef SKIP_DSPOTTER_RECOG
     return ASR_ERROR;
 #endif
@@ -147,6 +202,8 @@ asr_error_t asr_process(asr_port_t *ctx, int16_t *audio_buf, size_t buf_len)
 
     if (nRet == DSPOTTER_SUCCESS)
     {
+        // The result is given on the brick that completes the utterance
+        lpAsr->nResultEndIndex = lpAsr->nSampleCount;
         return ASR_OK;
     }
     else if (nRet == DSPOTTER_ERR_Expired)
@@ -162,9 +219,12 @@ asr_error_t asr_process(asr_port_t *ctx, int16_t *audio_buf, size_t buf_len)
 
 asr_error_t asr_get_result(asr_port_t *ctx, asr_result_t *result)
 {
+    dspotter_asr_t *lpAsr = (dspotter_asr_t *)ctx;
     char szCommand[64];
     int nCmdID, nCmdScore, nCmdSG, nCmdEnergy;
 
+    xassert(lpAsr == g_lpInstance);
+
     if (DSpotterHL_GetRecogResult(&nCmdID, NULL, szCommand, sizeof(szCommand), &nCmdScore, &nCmdSG, &nCmdEnergy, NULL) == DSPOTTER_SUCCESS)
     {
         DBG_TRACE("\r\nGet %s, ID=%d, Score=%d, SG_Diff=%d, Energy=%d\r\n", szCommand, nCmdID, nCmdScore, nCmdSG, nCmdEnergy);
@@ -172,10 +232,20 @@ asr_error_t asr_get_result(asr_port_t *ctx, asr_result_t *result)
 
         result->score = nCmdScore;
         result->gscore = nCmdSG;
-        // The following result fields are not implemented
-        result->start_index = -1;
-        result->end_index = -1;
-        result->duration = -1;
+        // DSpotterHL does not report where the utterance started. It must have been spoken
+        // within MAX_COMMAND_TIME of the end, so that span is given, starting no earlier
+        // than the first sample. Indices wrap from INT32_MAX to 0, so start_index can be
+        // above end_index on a device that has run for over 37 hours.
+        result->end_index = (int32_t)lpAsr->nResultEndIndex;
+        if (lpAsr->nResultEndIndex >= MAX_COMMAND_SAMPLES || lpAsr->bSampleCountWrapped)
+        {
+            result->start_index = (int32_t)((lpAsr->nResultEndIndex - MAX_COMMAND_SAMPLES) & INT32_MAX);
+        }
+        else
+        {
+            result->start_index = 0;
+        }
+        result->duration = (int32_t)((lpAsr->nResultEndIndex - (uint32_t)result->start_index) & INT32_MAX);
         return ASR_OK;
     }
     else
@@ -192,13 +262,15 @@ asr_error_t asr_reset(asr_port_t *ctx)
 
 asr_error_t asr_release(asr_port_t *ctx)
 {
+    dspotter_asr_t *lpAsr = (dspotter_asr_t *)ctx;
+
+    xassert(lpAsr == g_lpInstance);
+
     DSpotterHL_Release();
 
-    if (g_lpbyDSpotterMem != NULL)
-    {
-        devmem_free(devmem_ctx, g_lpbyDSpotterMem);
-        g_lpbyDSpotterMem = NULL;
-    }
+    devmem_free(devmem_ctx, lpAsr->lpbyDSpotterMem);
+    devmem_free(devmem_ctx, lpAsr);
+    g_lpInstance = NULL;
 
     return ASR_OK;
 }
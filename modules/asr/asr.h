@@ -38,6 +38,14 @@ void asr_printf(const char * format, ...) {
  * An ASR port can store any data needed in the context.
  * The context pointer is passed to all API methods and 
  * can be cast to any struct defined by the ASR port.
+ *
+ * Each call to asr_init returns a new instance with its own context, so
+ * an application can run several recognisers, such as two languages or
+ * one per audio channel. Ports keep all per-instance state in the
+ * context, and different instances may be called from different threads
+ * at the same time. One instance must only be called from one thread at
+ * a time, and asr_init and asr_release from one thread at a time. Ports whose library holds global state report a max_instances
+ * of 1 and fail asr_init while an instance is in use.
  */
 typedef void* asr_port_t;
 
@@ -55,6 +63,7 @@ typedef struct asr_attributes_struct
     char        engine_version[10];     ///< ASR port engine version
     char        model_version[10];      ///< Model version
     size_t      required_memory;    ///< Memory (in bytes) required by engine and model
+    int16_t     max_instances;      ///< Instances that can be in use at once
     void*       reserved;           ///< Reserved for future use
 } asr_attributes_t;
 
@@ -94,8 +103,9 @@ typedef enum asr_error_enum {
  * \param grammar    A pointer to the grammar data (Optional).
  * \param devmem_ctx A pointer to the device manager (Optional). 
  *                   Save this pointer if calling any device manager API functions.
+ *                   All instances must be given the same device manager.
  *
- * \returns the ASR port context.
+ * \returns the ASR port context, or NULL if the instance could not be created.
  */
 asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem_ctx);
 
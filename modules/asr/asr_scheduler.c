@@ -0,0 +1,130 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <string.h>
+
+#include <xcore/assert.h>
+#include <xcore/hwtimer.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "asr.h"
+#include "asr_scheduler.h"
+
+#define ASR_SCHED_NOTIFY_INDEX  (1) // Index 0 is left to the application
+
+typedef struct {
+    int instance;
+    asr_port_t ctx;
+    size_t samples_per_brick;
+    __attribute__((fptrgroup("asr_sched_result_fptr_grp")))
+    asr_sched_result_fn_t result_fn;
+    TaskHandle_t task;
+
+    // The pusher writes buf[next] while the task processes the other
+    asr_sample_t *buf[2];
+    volatile int next;
+    volatile int pending;   // Set by the pusher, cleared by the task when it takes buf[next]
+
+    asr_sched_stats_t stats;
+} asr_sched_instance_t;
+
+static asr_sched_instance_t *instances[ASR_SCHED_MAX_INSTANCES];
+static int instance_count;
+
+static void asr_sched_task(void *arg)
+{
+    asr_sched_instance_t *inst = arg;
+
+    for (;;) {
+        ulTaskNotifyTakeIndexed(ASR_SCHED_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+
+        while (inst->pending) {
+            asr_sample_t *brick = inst->buf[inst->next];
+            inst->next ^= 1;
+            inst->pending = 0;
+
+            uint32_t start = get_reference_time();
+            asr_error_t err = asr_process((asr_port_t *) inst->ctx, brick, inst->samples_per_brick);
+            uint32_t ticks = get_reference_time() - start;
+
+            inst->stats.bricks++;
+            if (ticks > inst->stats.max_ticks) {
+                inst->stats.max_ticks = ticks;
+            }
+
+            asr_result_t result;
+            if (err == ASR_OK &&
+                asr_get_result((asr_port_t *) inst->ctx, &result) == ASR_OK &&
+                result.id > 0) {
+                inst->result_fn(inst->instance, &result);
+            }
+        }
+    }
+}
+
+int asr_sched_add(asr_port_t ctx,
+                  size_t samples_per_brick,
+                  unsigned priority,
+                  asr_sched_result_fn_t result_fn)
+{
+    xassert(ctx);
+    xassert(result_fn);
+
+    if (instance_count >= ASR_SCHED_MAX_INSTANCES) {
+        asr_printf("ASR scheduler: all %d instances in use\n", ASR_SCHED_MAX_INSTANCES);
+        return -1;
+    }
+
+    asr_sched_instance_t *inst = pvPortMalloc(sizeof(asr_sched_instance_t));
+    asr_sample_t *bufs = pvPortMalloc(2 * samples_per_brick * sizeof(asr_sample_t));
+    if (inst == NULL || bufs == NULL) {
+        asr_printf("ASR scheduler: no memory for instance\n");
+        vPortFree(inst);
+        vPortFree(bufs);
+        return -1;
+    }
+
+    memset(inst, 0, sizeof(asr_sched_instance_t));
+    inst->instance = instance_count;
+    inst->ctx = ctx;
+    inst->samples_per_brick = samples_per_brick;
+    inst->result_fn = result_fn;
+    inst->buf[0] = bufs;
+    inst->buf[1] = bufs + samples_per_brick;
+
+    xTaskCreate((TaskFunction_t) asr_sched_task,
+                "asr_sched",
+                RTOS_THREAD_STACK_SIZE(asr_sched_task),
+                inst,
+                priority,
+                &inst->task);
+
+    instances[instance_count] = inst;
+    return instance_count++;
+}
+
+void asr_sched_push(int instance, const asr_sample_t *brick)
+{
+    xassert(instance >= 0 && instance < instance_count);
+    asr_sched_instance_t *inst = instances[instance];
+
+    if (inst->pending) {
+        inst->stats.overruns++;
+        return;
+    }
+
+    // The task does not touch buf[next] until pending is set
+    memcpy(inst->buf[inst->next], brick, inst->samples_per_brick * sizeof(asr_sample_t));
+    inst->pending = 1;
+    xTaskNotifyGiveIndexed(inst->task, ASR_SCHED_NOTIFY_INDEX);
+}
+
+void asr_sched_get_stats(int instance, asr_sched_stats_t *stats)
+{
+    xassert(instance >= 0 && instance < instance_count);
+    xassert(stats);
+
+    *stats = instances[instance]->stats;
+}
@@ -0,0 +1,86 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef XCORE_VOICE_ASR_SCHEDULER_H
+#define XCORE_VOICE_ASR_SCHEDULER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "asr.h"
+
+/**
+ * \addtogroup asr_sched_api asr_sched_api
+ *
+ * Runs several ASR instances side by side.
+ *
+ * Each instance added gets a task of its own, so the RTOS runs instances
+ * on whichever of the tile's cores are free rather than one after the
+ * other. The application pushes each brick of audio to the instances
+ * that want it and returns at once. An instance has until its next brick
+ * arrives to process the last one: a brick pushed while the one before is
+ * still waiting is dropped and counted as an overrun.
+ * @{
+ */
+
+/** Most instances one application can schedule */
+#ifndef ASR_SCHED_MAX_INSTANCES
+#define ASR_SCHED_MAX_INSTANCES     (4)
+#endif
+
+/**
+ * Called from an instance's task when asr_get_result reports a keyword
+ * or command. Give the function the attribute
+ * __attribute__((fptrgroup("asr_sched_result_fptr_grp"))) so the tools
+ * can size the instance tasks' stacks.
+ *
+ * \param instance   The instance, as returned by asr_sched_add.
+ * \param result     The result.
+ */
+typedef void (*asr_sched_result_fn_t)(int instance, const asr_result_t *result);
+
+/**
+ * Per-instance counters.
+ */
+typedef struct asr_sched_stats_struct
+{
+    uint32_t bricks;        ///< Bricks processed
+    uint32_t overruns;      ///< Bricks dropped because the previous one was still waiting
+    uint32_t max_ticks;     ///< Longest asr_process call, in reference clock ticks
+} asr_sched_stats_t;
+
+/**
+ * Add an instance and start its task.
+ *
+ * \param ctx                A context returned by asr_init.
+ * \param samples_per_brick  Samples in each brick the instance is pushed.
+ * \param priority           Priority of the instance's task.
+ * \param result_fn          Called with each result.
+ *
+ * \returns the instance number, or -1 if ASR_SCHED_MAX_INSTANCES are
+ *          already added or memory ran out.
+ */
+int asr_sched_add(asr_port_t ctx,
+                  size_t samples_per_brick,
+                  unsigned priority,
+                  asr_sched_result_fn_t result_fn);
+
+/**
+ * Push a brick to an instance. The brick is copied, and processed later
+ * in the instance's task. Only one thread may push to an instance.
+ *
+ * \param instance   The instance, as returned by asr_sched_add.
+ * \param brick      samples_per_brick samples.
+ */
+void asr_sched_push(int instance, const asr_sample_t *brick);
+
+/**
+ * Get the counters of an instance.
+ *
+ * \param instance   The instance, as returned by asr_sched_add.
+ * \param stats      The counters.
+ */
+void asr_sched_get_stats(int instance, asr_sched_stats_t *stats);
+
+/**@}*/
+
+#endif // XCORE_VOICE_ASR_SCHEDULER_H
@@ -3,11 +3,103 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <xs1.h>
 
 #include <xcore/assert.h>
 
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
 #include "device_memory.h"
 
+#if DEVMEM_CACHE_BYTES > 0
+
+#define DEVMEM_CACHE_SETS   (DEVMEM_CACHE_BYTES / (DEVMEM_CACHE_BLOCK_BYTES * DEVMEM_CACHE_WAYS))
+
+#if DEVMEM_CACHE_SETS < 1
+#error DEVMEM_CACHE_BYTES must hold at least DEVMEM_CACHE_WAYS blocks
+#endif
+
+typedef struct {
+    uintptr_t addr[DEVMEM_CACHE_WAYS];      // Flash address of each block, 0 if empty
+    uint32_t last_used[DEVMEM_CACHE_WAYS];
+} devmem_cache_set_t;
+
+static uint8_t cache_data[DEVMEM_CACHE_SETS][DEVMEM_CACHE_WAYS][DEVMEM_CACHE_BLOCK_BYTES] __attribute__((aligned(4)));
+static devmem_cache_set_t cache_sets[DEVMEM_CACHE_SETS];
+static uint32_t cache_clock;
+
+// Instances on other threads share the cache, and wait here while a miss is read
+static SemaphoreHandle_t cache_lock;
+
+#endif
+
+static devmem_cache_stats_t cache_stats;
+
+#if DEVMEM_CACHE_BYTES > 0
+
+static const uint8_t *devmem_cache_block(devmem_manager_t *ctx, uintptr_t addr) {
+    // Folding in the higher bits spreads blocks a multiple of the cache apart over different sets
+    const uintptr_t block = addr / DEVMEM_CACHE_BLOCK_BYTES;
+    const unsigned s = (block ^ (block / DEVMEM_CACHE_SETS)) % DEVMEM_CACHE_SETS;
+    devmem_cache_set_t *set = &cache_sets[s];
+    int victim = 0;
+
+    cache_clock++;
+    for (int w = 0; w < DEVMEM_CACHE_WAYS; w++) {
+        if (set->addr[w] == addr) {
+            set->last_used[w] = cache_clock;
+            cache_stats.hits++;
+            return cache_data[s][w];
+        }
+        if (set->addr[victim] != 0 && (set->addr[w] == 0 || set->last_used[w] < set->last_used[victim])) {
+            victim = w;
+        }
+    }
+
+    ctx->read_ext(cache_data[s][victim], (const void *) addr, DEVMEM_CACHE_BLOCK_BYTES);
+    set->addr[victim] = addr;
+    set->last_used[victim] = cache_clock;
+    cache_stats.misses++;
+    return cache_data[s][victim];
+}
+
+static void devmem_cache_lock(void) {
+    if (cache_lock == NULL) {
+        // Created on first use, the loser of a race to create it deletes its own
+        SemaphoreHandle_t lock = xSemaphoreCreateMutex();
+        xassert(lock);
+        taskENTER_CRITICAL();
+        if (cache_lock == NULL) {
+            cache_lock = lock;
+            lock = NULL;
+        }
+        taskEXIT_CRITICAL();
+        if (lock != NULL) {
+            vSemaphoreDelete(lock);
+        }
+    }
+    xSemaphoreTake(cache_lock, portMAX_DELAY);
+}
+
+static void devmem_cache_read(devmem_manager_t *ctx, uint8_t *dest, uintptr_t src, size_t n) {
+    devmem_cache_lock();
+    while (n > 0) {
+        const uintptr_t addr = src & ~(uintptr_t) (DEVMEM_CACHE_BLOCK_BYTES - 1);
+        const size_t offset = src - addr;
+        const size_t len = n < DEVMEM_CACHE_BLOCK_BYTES - offset ? n : DEVMEM_CACHE_BLOCK_BYTES - offset;
+
+        memcpy(dest, devmem_cache_block(ctx, addr) + offset, len);
+        dest += len;
+        src += len;
+        n -= len;
+    }
+    xSemaphoreGive(cache_lock);
+}
+
+#endif
+
 void *devmem_malloc(devmem_manager_t *ctx, size_t size) {
     xassert(ctx);    
     xassert(ctx->malloc);    
@@ -24,12 +116,28 @@ void devmem_read_ext(devmem_manager_t *ctx, void *dest, const void * src, size_t
     xassert(ctx);    
     xassert(ctx->read_ext);
     xassert((intptr_t)src % 4 == 0);
+    if (IS_FLASH(src)) {
+#if DEVMEM_CACHE_BYTES > 0
+        if (n <= DEVMEM_CACHE_MAX_READ_BYTES) {
+            devmem_cache_read(ctx, dest, (uintptr_t)src, n);
+            return;
+        }
+        // Counted under the lock, as hits and misses are, since instances read concurrently
+        devmem_cache_lock();
+        cache_stats.bypassed++;
+        xSemaphoreGive(cache_lock);
+#else
+        taskENTER_CRITICAL();
+        cache_stats.bypassed++;
+        taskEXIT_CRITICAL();
+#endif
+    }
     ctx->read_ext(dest, src, n);
 }
 
 int devmem_read_ext_async(devmem_manager_t *ctx, void *dest, const void * src, size_t n) {
     xassert(ctx);    
-    xassert(ctx->read_ext);    
+    xassert(ctx->read_ext_async);    
     xassert((intptr_t)src % 4 == 0);
     return ctx->read_ext_async(dest, src, n);
 }
@@ -38,4 +146,21 @@ void devmem_read_ext_wait(devmem_manager_t *ctx, int handle) {
     xassert(ctx);    
     xassert(ctx->read_ext_wait);    
     ctx->read_ext_wait(handle);
-}
\ No newline at end of file
+}
+
+void devmem_cache_get_stats(devmem_cache_stats_t *stats) {
+    xassert(stats);
+    *stats = cache_stats;
+}
+
+void devmem_cache_reset(void) {
+#if DEVMEM_CACHE_BYTES > 0
+    devmem_cache_lock();
+    memset(cache_sets, 0, sizeof(cache_sets));
+    cache_clock = 0;
+    memset(&cache_stats, 0, sizeof(cache_stats));
+    xSemaphoreGive(cache_lock);
+#else
+    memset(&cache_stats, 0, sizeof(cache_stats));
+#endif
+}
@@ -47,6 +47,40 @@ typedef struct devmem_manager_struct
 
 #define IS_FLASH(a)     IS_SWMEM(a)
 
+/**
+ * SRAM given to the block cache in devmem_read_ext. Reads from flash are
+ * made a block at a time through the cache, so weights a model reads
+ * often stay in SRAM. 0 disables the cache.
+ */
+#ifndef DEVMEM_CACHE_BYTES
+#define DEVMEM_CACHE_BYTES          (16 * 1024)
+#endif
+
+/** Bytes read from flash on each cache miss. A power of two */
+#ifndef DEVMEM_CACHE_BLOCK_BYTES
+#define DEVMEM_CACHE_BLOCK_BYTES    (256)
+#endif
+
+/** Blocks each address can be cached in. The least recently used is replaced */
+#ifndef DEVMEM_CACHE_WAYS
+#define DEVMEM_CACHE_WAYS           (4)
+#endif
+
+/** Reads larger than this bypass the cache, so one large read does not empty it */
+#ifndef DEVMEM_CACHE_MAX_READ_BYTES
+#define DEVMEM_CACHE_MAX_READ_BYTES (DEVMEM_CACHE_BYTES / 4)
+#endif
+
+/**
+ * Block cache counters, for sizing the cache for a model.
+ */
+typedef struct devmem_cache_stats_struct
+{
+    uint32_t hits;          ///< Blocks read from the cache
+    uint32_t misses;        ///< Blocks read from flash into the cache
+    uint32_t bypassed;      ///< Reads from flash too large to cache
+} devmem_cache_stats_t;
+
 /**
  * Memory allocation function that allows the application 
  * to provide an alternative implementation.
@@ -79,6 +113,9 @@ void devmem_free(devmem_manager_t *ctx, void *ptr);
  * Call devmem_read_ext instead of any other functions to read memory from 
  * flash, LPDDR or SDRAM. Modules are free to use memcpy if the dest and src 
  * are both SRAM addresses.
+ *
+ * Reads from flash go through the block cache, which is shared by every
+ * thread that calls this.
  * 
  * \param ctx      A pointer to the device memory context.
  * \param dest     A pointer to the destination array where the content is to be read.
@@ -111,6 +148,19 @@ int devmem_read_ext_async(devmem_manager_t *ctx, void *dest, const void * src, s
  */
 void devmem_read_ext_wait(devmem_manager_t *ctx, int handle);
 
+/**
+ * Get the block cache counters since start up or the last devmem_cache_reset.
+ *
+ * \param stats    The counters.
+ */
+void devmem_cache_get_stats(devmem_cache_stats_t *stats);
+
+/**
+ * Empty the block cache and zero its counters. Call this when the model in
+ * flash is changed, such as after a firmware update.
+ */
+void devmem_cache_reset(void);
+
 /**@}*/
 
 #endif // XCORE_DEVICE_MEMORY_H
@@ -0,0 +1,205 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <string.h>
+#include <xs1.h>
+
+#include <xcore/assert.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Library headers */
+#include "rtos_qspi_flash.h"
+
+#include "device_memory.h"
+#include "device_memory_flash.h"
+
+#define DEVMEM_FLASH_NOTIFY_INDEX   (1) /* Index 0 is left to the application */
+
+#define QSPI_FLASH_READ_MIN_SIZE    2
+
+typedef struct {
+    void *dest;
+    unsigned offset;
+    size_t n;
+    unsigned handle;
+} flash_request_t;
+
+typedef struct {
+    const uint8_t *src;     /* NULL if the buffer holds nothing */
+    size_t n;
+    int handle;
+    uint8_t buf[DEVMEM_FLASH_PREFETCH_BYTES] __attribute__((aligned(4)));
+} prefetch_t;
+
+static rtos_qspi_flash_t *qspi_flash_ctx;
+static QueueHandle_t request_queue;
+static SemaphoreHandle_t request_lock;
+static SemaphoreHandle_t read_ahead_lock;
+
+/* Handles are numbered in the order the flash task services them */
+static unsigned requested;
+static volatile unsigned completed;
+
+/* Tasks waiting for a read to complete, which need not be the tasks that
+ * queued it: the read ahead is waited on by whichever task reads next */
+static TaskHandle_t waiting[DEVMEM_FLASH_MAX_WAITERS];
+
+/* prefetch[current] holds the block being read, the other the block after it */
+static prefetch_t prefetch[2];
+static int current;
+
+static void flash_task(void *arg)
+{
+    (void) arg;
+
+    for (;;) {
+        flash_request_t req;
+        xQueueReceive(request_queue, &req, portMAX_DELAY);
+
+        rtos_qspi_flash_lock(qspi_flash_ctx);
+        if (req.n == 1) {
+            uint8_t temp_dest[QSPI_FLASH_READ_MIN_SIZE];
+            rtos_qspi_flash_read(qspi_flash_ctx, temp_dest, req.offset, sizeof(temp_dest));
+            *(uint8_t *) req.dest = temp_dest[0];
+        } else {
+            rtos_qspi_flash_read(qspi_flash_ctx, req.dest, req.offset, req.n);
+        }
+        rtos_qspi_flash_unlock(qspi_flash_ctx);
+
+        /* Every waiter is woken, and those whose read is still to come wait again */
+        TaskHandle_t wake[DEVMEM_FLASH_MAX_WAITERS];
+        taskENTER_CRITICAL();
+        completed = req.handle;
+        memcpy(wake, waiting, sizeof(wake));
+        memset(waiting, 0, sizeof(waiting));
+        taskEXIT_CRITICAL();
+
+        for (int i = 0; i < DEVMEM_FLASH_MAX_WAITERS; i++) {
+            if (wake[i] != NULL) {
+                xTaskNotifyGiveIndexed(wake[i], DEVMEM_FLASH_NOTIFY_INDEX);
+            }
+        }
+    }
+}
+
+static int flash_read_async(void *dest, const void *src, size_t n)
+{
+    flash_request_t req = {
+        .dest = dest,
+        .offset = (uintptr_t) src - XS1_SWMEM_BASE + QSPI_FLASH_MODEL_START_ADDRESS,
+        .n = n,
+    };
+
+    xassert(IS_FLASH(src));
+
+    /* Numbered and queued together, so handles complete in order */
+    xSemaphoreTake(request_lock, portMAX_DELAY);
+    req.handle = ++requested;
+    xQueueSend(request_queue, &req, portMAX_DELAY);
+    xSemaphoreGive(request_lock);
+
+    return req.handle;
+}
+
+static void flash_read_wait(int handle)
+{
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    for (;;) {
+        int i;
+
+        /* Checked and registered together, so a completion cannot fall between them */
+        taskENTER_CRITICAL();
+        if ((int) (completed - (unsigned) handle) >= 0) {
+            taskEXIT_CRITICAL();
+            return;
+        }
+        for (i = 0; i < DEVMEM_FLASH_MAX_WAITERS; i++) {
+            if (waiting[i] == NULL || waiting[i] == self) {
+                break;
+            }
+        }
+        xassert(i < DEVMEM_FLASH_MAX_WAITERS);
+        waiting[i] = self;
+        taskEXIT_CRITICAL();
+
+        ulTaskNotifyTakeIndexed(DEVMEM_FLASH_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+    }
+}
+
+static void prefetch_start(prefetch_t *p, const uint8_t *src)
+{
+    p->src = src;
+    p->n = DEVMEM_FLASH_PREFETCH_BYTES;
+    p->handle = flash_read_async(p->buf, src, p->n);
+}
+
+static int prefetch_holds(const prefetch_t *p, const uint8_t *src, size_t n)
+{
+    return p->src != NULL && src >= p->src && src + n <= p->src + p->n;
+}
+
+static void flash_read_locked(void *dest, const void *src, size_t n)
+{
+    const uint8_t *s = src;
+    prefetch_t *p = &prefetch[current];
+    prefetch_t *next = &prefetch[current ^ 1];
+
+    if (prefetch_holds(next, s, n)) {
+        /* Moved on to the next block: read ahead into the one just finished with */
+        current ^= 1;
+        prefetch_start(p, next->src + next->n);
+        p = next;
+    } else if (prefetch_holds(p, s, n)) {
+        if (next->src != p->src + p->n) {
+            prefetch_start(next, p->src + p->n);
+        }
+    } else {
+        /* Not a continuation of the last read, read it directly and restart the read ahead */
+        flash_read_wait(flash_read_async(dest, src, n));
+        prefetch_start(p, s + n);
+        next->src = NULL;
+        return;
+    }
+
+    flash_read_wait(p->handle);
+    memcpy(dest, p->buf + (s - p->src), n);
+}
+
+static void flash_read(void *dest, const void *src, size_t n)
+{
+    /* The read ahead buffers are shared by every ASR instance */
+    xSemaphoreTake(read_ahead_lock, portMAX_DELAY);
+    flash_read_locked(dest, src, n);
+    xSemaphoreGive(read_ahead_lock);
+}
+
+void devmem_flash_init(devmem_manager_t *ctx,
+                       rtos_qspi_flash_t *flash_ctx,
+                       unsigned priority)
+{
+    xassert(ctx);
+    xassert(flash_ctx);
+
+    qspi_flash_ctx = flash_ctx;
+    request_queue = xQueueCreate(DEVMEM_FLASH_MAX_REQUESTS, sizeof(flash_request_t));
+    request_lock = xSemaphoreCreateMutex();
+    read_ahead_lock = xSemaphoreCreateMutex();
+    xassert(request_queue && request_lock && read_ahead_lock);
+
+    xTaskCreate((TaskFunction_t) flash_task,
+                "devmem_flash",
+                RTOS_THREAD_STACK_SIZE(flash_task),
+                NULL,
+                priority,
+                NULL);
+
+    ctx->read_ext = flash_read;
+    ctx->read_ext_async = flash_read_async;
+    ctx->read_ext_wait = flash_read_wait;
+}
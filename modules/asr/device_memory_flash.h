@@ -0,0 +1,61 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef XCORE_DEVICE_MEMORY_FLASH_H
+#define XCORE_DEVICE_MEMORY_FLASH_H
+
+#include "rtos_qspi_flash.h"
+
+#include "device_memory.h"
+
+/**
+ * \addtogroup devmem_flash_api devmem_flash_api
+ *
+ * Extended memory reads for models kept in QSPI flash.
+ *
+ * Reads are queued to a flash task that services them in order, so an
+ * asynchronous read returns at once and its handle is waited on later.
+ * Synchronous reads go through the same queue, and read ahead: after each
+ * one, the block that follows it is fetched into one of two buffers while
+ * the ASR engine computes. A model streamed from flash front to back then
+ * finds most of its reads already done.
+ *
+ * There is one reader per application, shared by every ASR port.
+ * @{
+ */
+
+/* The offset in flash where the model(s) reside. */
+#ifndef QSPI_FLASH_MODEL_START_ADDRESS
+#define QSPI_FLASH_MODEL_START_ADDRESS    0x200000
+#endif
+
+/* Size of each read ahead buffer. Reads larger than this are not read ahead */
+#ifndef DEVMEM_FLASH_PREFETCH_BYTES
+#define DEVMEM_FLASH_PREFETCH_BYTES       1024
+#endif
+
+/* Reads that can be queued before devmem_read_ext_async blocks */
+#ifndef DEVMEM_FLASH_MAX_REQUESTS
+#define DEVMEM_FLASH_MAX_REQUESTS         4
+#endif
+
+/* Tasks that can wait on reads at the same time */
+#ifndef DEVMEM_FLASH_MAX_WAITERS
+#define DEVMEM_FLASH_MAX_WAITERS          4
+#endif
+
+/**
+ * Starts the flash task and sets the read_ext, read_ext_async and
+ * read_ext_wait functions of a device memory context. The malloc and free
+ * functions are left to the application.
+ *
+ * \param ctx          A pointer to the device memory context.
+ * \param flash_ctx    The QSPI flash driver holding the model.
+ * \param priority     Priority of the flash task.
+ */
+void devmem_flash_init(devmem_manager_t *ctx,
+                       rtos_qspi_flash_t *flash_ctx,
+                       unsigned priority);
+
+/**@}*/
+
+#endif // XCORE_DEVICE_MEMORY_FLASH_H
@@ -23,8 +23,9 @@ typedef struct sensory_asr_struct
 
 } sensory_asr_t;
 
+// Shared by all instances, as libTHFMicro calls xcore_memcpy without a context
 static devmem_manager_t *devmem_ctx = NULL;
-static sensory_asr_t sensory_asr;
+static int instance_count = 0;
 
 /**
  * Wrapper for devmem_read_ext called by libTHFMicro.
@@ -49,19 +50,36 @@ static BOOL xcore_is_flash(const void * ptr)
 asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
 {
     errors_t error;
-    appStruct_T *app = &(sensory_asr.app);
-    t2siStruct *t = &(app->_t);
+    sensory_asr_t *sensory_asr;
+    appStruct_T *app;
+    t2siStruct *t;
     unsigned int sppSize;
-    sensory_asr.brick_count = 0;
-    devmem_ctx = devmem;
 
-    memset((void *) app, 0, sizeof(appStruct_T)); // Most app parameters can be zero
+    xassert(devmem_ctx == NULL || devmem_ctx == devmem);
+    devmem_ctx = devmem;
 
     if (xcore_is_flash(grammar)) {
         asr_printf("ERROR: Search part (-search.BIN file) should be in SRAM.\n");
         return NULL;
     }
 
+    if (instance_count >= SENSORY_ASR_MAX_INSTANCES) {
+        asr_printf("ERROR: All %d Sensory instances are in use\n", SENSORY_ASR_MAX_INSTANCES);
+        return NULL;
+    }
+
+    sensory_asr = devmem_malloc(devmem_ctx, sizeof(sensory_asr_t));
+    if (sensory_asr == NULL)
+    {
+        asr_printf("ERROR: No memory left for the instance\n");
+        return NULL;
+    }
+    instance_count++;
+
+    memset((void *) sensory_asr, 0, sizeof(sensory_asr_t)); // Most app parameters can be zero
+    app = &(sensory_asr->app);
+    t = &(app->_t);
+
     // Some parameters
     t->maxResults = SENSORY_ASR_MAX_RESULTS ? SENSORY_ASR_MAX_RESULTS : MAX_RESULTS;
     t->maxTokens = SENSORY_ASR_MAX_TOKENS ? SENSORY_ASR_MAX_TOKENS : MAX_TOKENS;
@@ -79,6 +97,7 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
     if (app->audioBufferStart == NULL)
     {
         asr_printf("ERROR: Audio buffer out of memory\n");
+        asr_release((asr_port_t *) sensory_asr);
         return NULL;
     }
 
@@ -92,6 +111,7 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
     error = SensoryAlloc(app, &sppSize);  // Find size needed
     if (error) {
         asr_printf("ERROR: SensoryAlloc failed with error 0x%x\n", error);
+        asr_release((asr_port_t *) sensory_asr);
         return NULL;
     }
     asr_printf("Sensory SPP size=%u (bytes)\n", sppSize);
@@ -101,6 +121,7 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
     if (t->spp == NULL)
     {
         asr_printf("ERROR: No memory left for SPP\n");
+        asr_release((asr_port_t *) sensory_asr);
         return NULL;
     }
 
@@ -108,11 +129,12 @@ asr_port_t asr_init(int32_t *model, int32_t *grammar, devmem_manager_t *devmem)
     error = SensoryProcessInit(app);
     if (error) {
         asr_printf("ERROR: SensoryProcessInit failed with error 0x%x\n", error);
+        asr_release((asr_port_t *) sensory_asr);
         return NULL;
     }
 
     asr_printf("SensoryProcessInit succeeded\n");
-    return (asr_port_t) &sensory_asr;
+    return (asr_port_t) sensory_asr;
 }
 
 #pragma stackfunction 250
@@ -218,6 +240,7 @@ asr_error_t asr_get_attributes(asr_port_t *ctx, asr_attributes_t *attributes)
     xassert(attributes);
 
     attributes->samples_per_brick = FRAME_LEN;
+    attributes->max_instances = SENSORY_ASR_MAX_INSTANCES;
 
     infoStruct_T info;
     errors_t err = SensoryInfo(&info);
@@ -256,6 +279,7 @@ asr_error_t asr_release(asr_port_t *ctx)
         app->audioBufferStart = 0;
     }
 
-    ctx = NULL;
+    devmem_free(devmem_ctx, (void *) sensory_asr);
+    instance_count--;
     return ASR_OK;
 }
@@ -18,6 +18,11 @@
 #define SENSORY_ASR_ADDITIONAL_ROM_CACHE    (0)
 #endif
 
+#ifndef SENSORY_ASR_MAX_INSTANCES
+// Recognisers that can run at once, each with its own model and memory
+#define SENSORY_ASR_MAX_INSTANCES           (2)
+#endif
+
 #ifndef SENSORY_ASR_KEEP_GOING
 #define SENSORY_ASR_KEEP_GOING              (1)
 #endif
@@ -0,0 +1,212 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "aec_defines.h"
+#include "aec_api.h"
+
+/* This is an example of processing one frame of data through the AEC pipeline stage on 2 threads. It runs the same
+ * steps, in the same order, as aec_process_frame_1thread(). Each step that can be split is shared between the calling
+ * task and a helper task, which the scheduler runs on another core. Both must finish a step before either starts the
+ * next one, so every call to aec_par_run() is a barrier.
+ *
+ * Work is split by (filter, channel) wherever steps only touch their own channel's buffers. The filter update is
+ * split by filter only: the main filter T buffer is shared between y channels, so the y channels of one filter must
+ * be adapted in turn. This is also why more than 2 threads would not help.
+ */
+
+#define AEC_THREADS             (2)
+#define AEC_PAR_NOTIFY_INDEX    (1) /* Index 0 is left to the application */
+
+typedef struct {
+    aec_state_t *main_state;
+    aec_state_t *shadow_state;
+    int32_t (*output_main)[AEC_FRAME_ADVANCE];
+    int32_t (*output_shadow)[AEC_FRAME_ADVANCE];
+    unsigned X_energy_recalc_bin;
+} aec_par_args_t;
+
+typedef void (*aec_par_job_t)(const aec_par_args_t *args, int tid);
+
+static struct {
+    TaskHandle_t helper;
+    TaskHandle_t caller;
+    aec_par_job_t job;
+    const aec_par_args_t *args;
+} aec_par;
+
+static unsigned X_energy_recalc_bin = 0;
+
+static void aec_par_helper(void *arg)
+{
+    (void) arg;
+
+    for (;;) {
+        ulTaskNotifyTakeIndexed(AEC_PAR_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+        aec_par.job(aec_par.args, 1);
+        xTaskNotifyGiveIndexed(aec_par.caller, AEC_PAR_NOTIFY_INDEX);
+    }
+}
+
+/* Runs job on both threads, returning once both have finished */
+static void aec_par_run(aec_par_job_t job, const aec_par_args_t *args)
+{
+    aec_par.job = job;
+    aec_par.args = args;
+    aec_par.caller = xTaskGetCurrentTaskHandle();
+
+    xTaskNotifyGiveIndexed(aec_par.helper, AEC_PAR_NOTIFY_INDEX);
+    job(args, 0);
+    ulTaskNotifyTakeIndexed(AEC_PAR_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+}
+
+/* EMA energy and spectrum of each mic and reference channel */
+static void aec_par_input_spectrum(const aec_par_args_t *args, int tid)
+{
+    aec_shared_state_t *shared_state = args->main_state->shared_state;
+    int num_y_channels = shared_state->num_y_channels;
+    int num_x_channels = shared_state->num_x_channels;
+
+    for(int i=tid; i<num_y_channels + num_x_channels; i+=AEC_THREADS) {
+        if(i < num_y_channels) {
+            int ch = i;
+            aec_calc_time_domain_ema_energy(&shared_state->y_ema_energy[ch], &shared_state->y[ch],
+                    AEC_PROC_FRAME_LENGTH - AEC_FRAME_ADVANCE, AEC_FRAME_ADVANCE, &shared_state->config_params);
+            aec_forward_fft(&shared_state->Y[ch], &shared_state->y[ch]);
+        } else {
+            int ch = i - num_y_channels;
+            aec_calc_time_domain_ema_energy(&shared_state->x_ema_energy[ch], &shared_state->x[ch],
+                    AEC_PROC_FRAME_LENGTH - AEC_FRAME_ADVANCE, AEC_FRAME_ADVANCE, &shared_state->config_params);
+            aec_forward_fft(&shared_state->X[ch], &shared_state->x[ch]);
+        }
+    }
+}
+
+/* Sum of X energy over the X FIFO, main filter on thread 0 and shadow filter on thread 1 */
+static void aec_par_X_fifo_energy(const aec_par_args_t *args, int tid)
+{
+    aec_state_t *state = (tid == 0) ? args->main_state : args->shadow_state;
+    int num_x_channels = state->shared_state->num_x_channels;
+
+    for(int ch=0; ch<num_x_channels; ch++) {
+        aec_calc_X_fifo_energy(state, ch, args->X_energy_recalc_bin);
+    }
+}
+
+/* Error, output and error spectrum energy for one filter and y channel. Items are ordered so that each thread gets
+ * one main and one shadow filter channel when there are 2 y channels.
+ */
+static void aec_par_error(const aec_par_args_t *args, int tid)
+{
+    aec_state_t *main_state = args->main_state;
+    aec_state_t *shadow_state = args->shadow_state;
+    int num_y_channels = main_state->shared_state->num_y_channels;
+
+    for(int w=tid; w<2*num_y_channels; w+=AEC_THREADS) {
+        int ch = w / 2;
+        int is_main = (w & 1) == (ch & 1);
+
+        if(is_main) {
+            aec_calc_Error_and_Y_hat(main_state, ch);
+            aec_inverse_fft(&main_state->error[ch], &main_state->Error[ch]);
+            aec_inverse_fft(&main_state->y_hat[ch], &main_state->Y_hat[ch]);
+            aec_calc_coherence(main_state, ch);
+            aec_calc_output(main_state, &args->output_main[ch], ch);
+
+            bfp_s32_t temp;
+            bfp_s32_init(&temp, &args->output_main[ch][0], -31, AEC_FRAME_ADVANCE, 1);
+            aec_calc_time_domain_ema_energy(&main_state->error_ema_energy[ch], &temp, 0, AEC_FRAME_ADVANCE, &main_state->shared_state->config_params);
+
+            aec_forward_fft(&main_state->Error[ch], &main_state->error[ch]);
+            aec_calc_freq_domain_energy(&main_state->overall_Error[ch], &main_state->Error[ch]);
+            aec_calc_freq_domain_energy(&main_state->shared_state->overall_Y[ch], &main_state->shared_state->Y[ch]);
+        } else {
+            aec_calc_Error_and_Y_hat(shadow_state, ch);
+            aec_inverse_fft(&shadow_state->error[ch], &shadow_state->Error[ch]);
+            if(args->output_shadow != NULL) {
+                aec_calc_output(shadow_state, &args->output_shadow[ch], ch);
+            }
+            else {
+                aec_calc_output(shadow_state, NULL, ch);
+            }
+            aec_forward_fft(&shadow_state->Error[ch], &shadow_state->error[ch]);
+            aec_calc_freq_domain_energy(&shadow_state->overall_Error[ch], &shadow_state->Error[ch]);
+        }
+    }
+}
+
+/* Normalisation spectrum, T and filter update, main filter on thread 0 and shadow filter on thread 1 */
+static void aec_par_adapt(const aec_par_args_t *args, int tid)
+{
+    int is_shadow = (tid == 1);
+    aec_state_t *state = is_shadow ? args->shadow_state : args->main_state;
+    int num_y_channels = state->shared_state->num_y_channels;
+    int num_x_channels = state->shared_state->num_x_channels;
+
+    for(int ch=0; ch<num_x_channels; ch++) {
+        aec_calc_normalisation_spectrum(state, ch, is_shadow);
+    }
+
+    for(int ych=0; ych<num_y_channels; ych++) {
+        for(int xch=0; xch<num_x_channels; xch++) {
+            aec_calc_T(state, ych, xch);
+        }
+        aec_filter_adapt(state, ych);
+    }
+}
+
+void aec_process_frame_2threads_init(UBaseType_t priority)
+{
+    xTaskCreate((TaskFunction_t) aec_par_helper,
+                "aec_par_helper",
+                configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(aec_par_helper),
+                NULL,
+                priority,
+                &aec_par.helper);
+    configASSERT(aec_par.helper != NULL);
+}
+
+void aec_process_frame_2threads(
+        aec_state_t *main_state,
+        aec_state_t *shadow_state,
+        int32_t (*output_main)[AEC_FRAME_ADVANCE],
+        int32_t (*output_shadow)[AEC_FRAME_ADVANCE],
+        const int32_t (*y_data)[AEC_FRAME_ADVANCE],
+        const int32_t (*x_data)[AEC_FRAME_ADVANCE])
+{
+    int num_x_channels = main_state->shared_state->num_x_channels;
+    aec_par_args_t args = {
+        .main_state = main_state,
+        .shadow_state = shadow_state,
+        .output_main = output_main,
+        .output_shadow = output_shadow,
+        .X_energy_recalc_bin = X_energy_recalc_bin,
+    };
+
+    aec_frame_init(main_state, shadow_state, y_data, x_data);
+
+    aec_par_run(aec_par_input_spectrum, &args);
+    aec_par_run(aec_par_X_fifo_energy, &args);
+
+    X_energy_recalc_bin += 1;
+    if(X_energy_recalc_bin == (AEC_PROC_FRAME_LENGTH/2) + 1) {
+        X_energy_recalc_bin = 0;
+    }
+
+    for(int ch=0; ch<num_x_channels; ch++) {
+        aec_update_X_fifo_and_calc_sigmaXX(main_state, ch);
+    }
+    aec_update_X_fifo_1d(main_state);
+    aec_update_X_fifo_1d(shadow_state);
+
+    aec_par_run(aec_par_error, &args);
+
+    aec_compare_filters_and_calc_mu(
+            main_state,
+            shadow_state);
+
+    aec_par_run(aec_par_adapt, &args);
+}
@@ -5,7 +5,12 @@
 #define AUDIO_PIPELINE_DSP_H_
 
 #include <stdint.h>
+#include <stddef.h>
 #include "app_conf.h"
+#include "stage_profiler.h"
+#include "pipeline_telemetry.h"
+#include "audio_pipeline_ctrl.h"
+#include "audio_pipeline.h"
 
 /* Pipeline config */
 #define AP_MAX_Y_CHANNELS (2)
@@ -18,6 +23,29 @@
 #define AEC_MAIN_FILTER_PHASES    (10)
 #define AEC_SHADOW_FILTER_PHASES    (5)
 
+/* Phases the memory pools are sized for. The filter length can be changed at run time within these */
+#ifndef AEC_MAX_MAIN_FILTER_PHASES
+#define AEC_MAX_MAIN_FILTER_PHASES    (15)
+#endif
+#ifndef AEC_MAX_SHADOW_FILTER_PHASES
+#define AEC_MAX_SHADOW_FILTER_PHASES    (AEC_SHADOW_FILTER_PHASES)
+#endif
+
+/* Most phases the pools hold when the AEC runs with fewer than the maximum channels */
+#define AEC_POOL_MAIN_FILTER_PHASES(y, x)   (((AEC_MAX_Y_CHANNELS * AEC_MAX_X_CHANNELS) + AEC_MAX_X_CHANNELS) * AEC_MAX_MAIN_FILTER_PHASES / (((y) * (x)) + (x)))
+#define AEC_POOL_SHADOW_FILTER_PHASES(y, x) ((AEC_MAX_Y_CHANNELS * AEC_MAX_X_CHANNELS) * AEC_MAX_SHADOW_FILTER_PHASES / ((y) * (x)))
+
+/* Cost model for run time filter length changes, see audio_pipeline_aec_profile_t.
+ * Estimates for one thread, re-measure with the STAGE_PROFILE servicer command */
+#define AEC_BUDGET_US               (12000) /* ADEC and the delay buffer share the stage */
+#define AEC_COST_FIXED_US           (2000)
+#define AEC_COST_PER_PHASE_US       (150)
+
+/* Hardware threads the AEC runs on, 1 or 2. With 2, a helper task takes half the work of each frame */
+#ifndef NUM_AEC_THREADS
+#define NUM_AEC_THREADS (2)
+#endif
+
 /* Delay buffer config */
 #define MAX_DELAY_BUF_CHANNELS (2)
 #define DELAY_BUF_MAX_DELAY_MS                ( 150 )
@@ -40,13 +68,32 @@ typedef struct {
     int32_t aec_reference_audio_samples[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     int32_t mic_samples_passthrough[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
 
+    /* Filled in by the tile 0 stages and published by the output, not sent between tiles */
+    pipeline_telemetry_t telemetry;
+
     /* Below is additional context needed by other stages on a per frame basis */
     int32_t vnr_pred_flag;
     float_s32_t max_ref_energy;
     float_s32_t aec_corr_factor;
     int32_t ref_active_flag;
+
+    /* Settings from tile 0 that this frame is processed with, latched on tile 1 */
+    audio_pipeline_ctrl_t ctrl;
+
+    /* Tile 1 stage timings, reported by the tile 0 configuration servicer */
+    stage_profiler_snapshot_t stage_profile;
+
+    /* State of the app's input on tile 1, reported by the tile 0 configuration servicer */
+    audio_pipeline_input_status_t input_status;
 } frame_data_t;
 
+/* Everything after the audio, sent between tiles alongside the channels */
+#define AP_FRAME_METADATA(frame_data)   (&(frame_data)->vnr_pred_flag)
+#define AP_FRAME_METADATA_BYTES         (sizeof(frame_data_t) - offsetof(frame_data_t, vnr_pred_flag))
+
+/* Channels in frame_data_t, in audio_pipeline_output() order */
+#define AP_FRAME_CHANNELS               (3 * appconfAUDIO_PIPELINE_CHANNELS)
+
 typedef struct aec_ctx {
     aec_state_t DWORD_ALIGNED aec_main_state;
     aec_state_t DWORD_ALIGNED aec_shadow_state;
@@ -4,6 +4,7 @@
 /* STD headers */
 #include <string.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <xcore/hwtimer.h>
 
 /* FreeRTOS headers */
@@ -21,52 +22,86 @@
 #include "app_conf.h"
 #include "audio_pipeline.h"
 #include "audio_pipeline_dsp.h"
+#include "stage_profiler.h"
+#include "frame_pool.h"
+#include "audio_pipeline_wire.h"
+#include "audio_pipeline_ctrl.h"
 #include "stage_1.h"
 
 #if appconfAUDIO_PIPELINE_FRAME_ADVANCE != 240
 #error This pipeline is only configured for 240 frame advance
 #endif
 
+#define AUDIO_PIPELINE_STAGE_COUNT (1)
+
 #if ON_TILE(1)
 // Stage1 - AEC, DE, ADEC
 static stage_1_state_t DWORD_ALIGNED stage_1_state;
 static aec_conf_t aec_de_mode_conf;
 static aec_conf_t aec_non_de_mode_conf;
 static adec_config_t adec_conf;
+static int profiler_first_slot;
+static frame_data_t DWORD_ALIGNED frame_pool_storage[FRAME_POOL_DEPTH(AUDIO_PIPELINE_STAGE_COUNT)];
+static frame_pool_t frame_pool;
 
 static void *audio_pipeline_input_i(void *input_app_data)
 {
     frame_data_t *frame_data;
 
-    frame_data = pvPortMalloc(sizeof(frame_data_t));
-    memset(frame_data, 0x00, sizeof(frame_data_t));
+    frame_data = frame_pool_acquire(&frame_pool);
+
+    /* Every sample is overwritten below, so only the metadata after them needs clearing */
+    memset(&frame_data->vnr_pred_flag, 0x00, sizeof(frame_data_t) - offsetof(frame_data_t, vnr_pred_flag));
 
     audio_pipeline_input(input_app_data,
                        (int32_t **)frame_data->aec_reference_audio_samples,
                        4,
                        appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
-    frame_data->vnr_pred_flag = 0;
+    audio_pipeline_input_status(input_app_data, &frame_data->input_status);
 
     memcpy(frame_data->samples, frame_data->mic_samples_passthrough, sizeof(frame_data->samples));
 
+    /* The settings are latched per frame so both tiles see the same ones */
+    audio_pipeline_ctrl_poll(intertile_ctx);
+    audio_pipeline_ctrl_get(&frame_data->ctrl);
+
     return frame_data;
 }
 
 static int audio_pipeline_output_i(frame_data_t *frame_data,
                                    void *output_app_data)
 {
-    rtos_intertile_tx(intertile_ctx,
-                      appconfAUDIOPIPELINE_PORT,
-                      frame_data,
-                      sizeof(frame_data_t));
-    return AUDIO_PIPELINE_FREE_FRAME;
+    stage_profiler_snapshot(&frame_data->stage_profile, profiler_first_slot, AUDIO_PIPELINE_STAGE_COUNT);
+
+    /* Only the channels tile 0 asked for are sent */
+    ap_wire_send(intertile_ctx,
+                 appconfAUDIOPIPELINE_PORT,
+                 frame_data->ctrl.wire_format,
+                 frame_data->ctrl.channel_mask,
+                 frame_data->ctrl.seq,
+                 AP_FRAME_METADATA(frame_data),
+                 AP_FRAME_METADATA_BYTES,
+                 &frame_data->samples[0][0],
+                 AP_FRAME_CHANNELS,
+                 appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    frame_pool_release(&frame_pool, frame_data);
+    return AUDIO_PIPELINE_DONT_FREE_FRAME;
 }
 
 static void stage_aec(frame_data_t *frame_data)
 {
-#if appconfAUDIO_PIPELINE_SKIP_AEC
-#else
+    if (frame_data->ctrl.bypass_mask & AP_BYPASS_AEC) {
+        return;
+    }
+
+    /* Tile 0 has checked that the filter length fits */
+    if (frame_data->ctrl.aec_main_phases != 0) {
+        stage_1_set_aec_phases(&stage_1_state,
+                               frame_data->ctrl.aec_main_phases,
+                               frame_data->ctrl.aec_shadow_phases);
+    }
+
     int32_t DWORD_ALIGNED stage_1_out[AEC_MAX_Y_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
 
     stage_1_process_frame(&stage_1_state,
@@ -78,7 +113,6 @@ static void stage_aec(frame_data_t *frame_data)
                           frame_data->aec_reference_audio_samples);
 
     memcpy(frame_data->samples, stage_1_out, AEC_MAX_Y_CHANNELS * appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
-#endif
 }
 
 static void initialize_pipeline_stages(void)
@@ -103,9 +137,9 @@ void audio_pipeline_init(
     void *input_app_data,
     void *output_app_data)
 {
-    const int stage_count = 1;
+    const int stage_count = AUDIO_PIPELINE_STAGE_COUNT;
 
-    const pipeline_stage_t stages[] = {
+    pipeline_stage_t stages[] = {
         (pipeline_stage_t)stage_aec,
     };
 
@@ -114,7 +148,13 @@ void audio_pipeline_init(
 
     };
 
+    const char * const stage_names[] = {
+        "stage_aec",
+    };
+
+    frame_pool_init(&frame_pool, "tile1", frame_pool_storage, sizeof(frame_data_t), FRAME_POOL_DEPTH(stage_count));
     initialize_pipeline_stages();
+    profiler_first_slot = stage_profiler_wrap(stages, stage_names, stage_count);
 
     generic_pipeline_init((pipeline_input_t)audio_pipeline_input_i,
                         (pipeline_output_t)audio_pipeline_output_i,
@@ -1,6 +1,7 @@
 // Copyright 2022-2023 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
+#include "FreeRTOS.h"
 #include "audio_pipeline_dsp.h"
 #include "stage_1.h"
 
@@ -12,6 +13,8 @@ extern void aec_process_frame_2threads(
         const int32_t (*y_data)[AEC_FRAME_ADVANCE],
         const int32_t (*x_data)[AEC_FRAME_ADVANCE]);
 
+extern void aec_process_frame_2threads_init(UBaseType_t priority);
+
 extern void aec_process_frame_1thread(
         aec_state_t *main_state,
         aec_state_t *shadow_state,
@@ -36,16 +39,12 @@ static inline void get_delayed_frame(
     int num_channels = (delay_state->delay_samples) > 0 ? AP_MAX_Y_CHANNELS : AP_MAX_X_CHANNELS;
     if (delay_state->delay_samples >= 0) {/** Requested Mic delay +ve => delay mic*/
         for(int ch=0; ch<num_channels; ch++) {
-            for(int i=0; i<AP_FRAME_ADVANCE; i++) {
-                get_delayed_sample(delay_state, &input_y_data[ch][i], ch);
-            }
+            get_delayed_samples(delay_state, &input_y_data[ch][0], ch, AP_FRAME_ADVANCE);
         }
     }
     else if (delay_state->delay_samples < 0) {/* Requested Mic delay negative => advance mic which can't be done, so delay reference*/
         for(int ch=0; ch<num_channels; ch++) {
-            for(int i=0; i<AP_FRAME_ADVANCE; i++) {
-                get_delayed_sample(delay_state, &input_x_data[ch][i], ch);
-            }
+            get_delayed_samples(delay_state, &input_x_data[ch][0], ch, AP_FRAME_ADVANCE);
         }
     }
     return;
@@ -62,6 +61,9 @@ void stage_1_init(stage_1_state_t *state, aec_conf_t *de_conf, aec_conf_t *non_d
     memcpy(&state->aec_non_de_mode_conf, non_de_conf, sizeof(aec_conf_t));
 
     adec_init(&state->adec_state, adec_config);
+#if (NUM_AEC_THREADS > 1)
+    aec_process_frame_2threads_init(appconfAUDIO_PIPELINE_TASK_PRIORITY);
+#endif
     aec_switch_configuration(state, &state->aec_non_de_mode_conf);
 }
 
@@ -116,6 +118,23 @@ static void alt_arch_rewrite_output(int32_t (*output)[AP_FRAME_ADVANCE], const i
     }
 }
 
+void stage_1_set_aec_phases(stage_1_state_t *state, uint8_t num_main_filt_phases, uint8_t num_shadow_filt_phases)
+{
+    aec_conf_t *conf = &state->aec_non_de_mode_conf;
+
+    if (conf->num_main_filt_phases == num_main_filt_phases &&
+        conf->num_shadow_filt_phases == num_shadow_filt_phases) {
+        return;
+    }
+
+    conf->num_main_filt_phases = num_main_filt_phases;
+    conf->num_shadow_filt_phases = num_shadow_filt_phases;
+
+    if (!state->delay_estimator_enabled) {
+        aec_switch_configuration(state, conf);
+    }
+}
+
 /** Process a frame of data through AEC and ADEC*/
 static int framenum = 0;
 void stage_1_process_frame(stage_1_state_t *state, int32_t (*output_frame)[AP_FRAME_ADVANCE],
@@ -47,6 +47,13 @@ typedef struct {
 
 void stage_1_init(stage_1_state_t *state, aec_conf_t *de_conf, aec_conf_t *non_de_conf, adec_config_t *adec_config);
 
+/**
+ * Sets the AEC filter length used outside delay estimation. If the AEC is
+ * running with it, the AEC is re-initialised, which restarts adaption.
+ * Otherwise it applies when delay estimation ends.
+ */
+void stage_1_set_aec_phases(stage_1_state_t *state, uint8_t num_main_filt_phases, uint8_t num_shadow_filt_phases);
+
 void stage_1_process_frame(stage_1_state_t *state, int32_t (*output_frame)[AP_FRAME_ADVANCE],
     float_s32_t *max_ref_energy, float_s32_t *aec_corr_factor, int32_t *ref_active_flag,
     int32_t (*input_y)[AP_FRAME_ADVANCE], int32_t (*input_x)[AP_FRAME_ADVANCE]);
@@ -10,6 +10,13 @@
 #define AUDIO_PIPELINE_DONT_FREE_FRAME 0
 #define AUDIO_PIPELINE_FREE_FRAME      1
 
+/* State of the app's audio input, carried with each frame to the output tile */
+typedef struct {
+    int32_t ref_rate_ppb;   /* Reference clock offset from the mic clock, in parts per billion */
+    uint32_t ref_fill;      /* Reference frames buffered between the two clocks */
+    uint32_t ref_xruns;     /* Times that buffer ran dry or overflowed */
+} audio_pipeline_input_status_t;
+
 void audio_pipeline_init(
         void *input_app_data,
         void *output_app_data);
@@ -26,4 +33,19 @@ int audio_pipeline_output(
         size_t ch_count,
         size_t frame_count);
 
+/**
+ * Provided by the application. Returns a bitmask of the channels, in
+ * audio_pipeline_output() order, that audio_pipeline_output() currently
+ * reads. Channels that are not set may be left stale or zeroed by the
+ * pipeline. Called once per frame from the pipeline output task.
+ */
+uint32_t audio_pipeline_output_channels(void *output_app_data);
+
+/**
+ * Provided by the application. Fills in the state of the input as of the
+ * last audio_pipeline_input() call. Called once per frame from the pipeline
+ * input task, after audio_pipeline_input().
+ */
+void audio_pipeline_input_status(void *input_app_data, audio_pipeline_input_status_t *status);
+
 #endif /* AUDIO_PIPELINE_H_ */
@@ -0,0 +1,304 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_printf.h"
+
+/* App headers */
+#include "app_conf.h"
+#include "platform/driver_instances.h"
+#include "audio_pipeline_wire.h"
+#include "audio_pipeline_ctrl.h"
+
+#define AP_CTRL_BARRIER() asm volatile("" ::: "memory")
+
+#define AP_CTRL_DEFAULT {                           \
+    .seq = 0,                                       \
+    .channel_mask = (1 << AP_WIRE_MAX_CHANNELS) - 1, \
+    .wire_format = AP_WIRE_FORMAT_S32,              \
+    .bypass_mask = AP_BYPASS_DEFAULT,               \
+    .aec_main_phases = 0,                           \
+    .aec_shadow_phases = 0,                         \
+    .mic_delay_samples = AP_MIC_DELAY_DEFAULT,      \
+}
+
+/*
+ * Tile 0: settings as set by the application, of which only the bypass
+ * mask, AEC filter length and mic delay are used. The AEC phases are 0
+ * until set. Written from any task in a critical section, so that several
+ * settings can change together, and read by the pipeline output without
+ * one, so they are guarded by a sequence count as on tile 1.
+ */
+static audio_pipeline_ctrl_t requested = AP_CTRL_DEFAULT;
+static volatile uint32_t requested_version;
+
+/* Tile 0: what the AEC can run, and the most mic delay either way */
+static const audio_pipeline_aec_profile_t *aec_profile;
+static int32_t mic_delay_max;
+
+/* Tile 0: values to start with, set before the pipeline registers the
+ * limits they are checked against. 0 phases for the pipeline's default */
+static uint16_t aec_phases_default;
+static int32_t mic_delay_default = AP_MIC_DELAY_DEFAULT;
+
+/* Tile 0: tile 1 input status, from the last frame received */
+static audio_pipeline_input_status_t input_status;
+
+/* Tile 0: last message sent. Only touched by the pipeline output task */
+static audio_pipeline_ctrl_t sent = AP_CTRL_DEFAULT;
+
+/*
+ * Tile 1: last message applied. Written by the pipeline input task and read
+ * by any stage, so it is guarded by a sequence count that is odd while a
+ * write is in progress.
+ */
+static audio_pipeline_ctrl_t applied = AP_CTRL_DEFAULT;
+static volatile uint32_t applied_version;
+
+/* Writers must not run concurrently with each other */
+static void ctrl_write(audio_pipeline_ctrl_t *dst, volatile uint32_t *version, const audio_pipeline_ctrl_t *src)
+{
+    (*version)++;
+    AP_CTRL_BARRIER();
+    *dst = *src;
+    AP_CTRL_BARRIER();
+    (*version)++;
+}
+
+static void ctrl_read(audio_pipeline_ctrl_t *dst, volatile uint32_t *version, const audio_pipeline_ctrl_t *src)
+{
+    uint32_t v;
+
+    do {
+        v = *version;
+        AP_CTRL_BARRIER();
+        *dst = *src;
+        AP_CTRL_BARRIER();
+    } while ((v & 1) || v != *version);
+}
+
+void audio_pipeline_ctrl_sync(rtos_intertile_t *ctx, uint8_t channel_mask, const audio_pipeline_ctrl_t *settings)
+{
+    audio_pipeline_ctrl_t next = sent;
+
+    next.channel_mask = channel_mask;
+    next.wire_format = appconfAUDIO_PIPELINE_WIRE_FORMAT;
+    next.bypass_mask = settings->bypass_mask;
+    next.aec_main_phases = settings->aec_main_phases;
+    next.aec_shadow_phases = settings->aec_shadow_phases;
+    next.mic_delay_samples = settings->mic_delay_samples;
+
+    if (memcmp(&next, &sent, sizeof(next)) == 0) {
+        return;
+    }
+
+    next.seq = sent.seq + 1;
+    sent = next;
+    rtos_intertile_tx(ctx, appconfAUDIOPIPELINE_CTRL_PORT, &sent, sizeof(sent));
+}
+
+void audio_pipeline_ctrl_get_settings(audio_pipeline_ctrl_t *settings)
+{
+    ctrl_read(settings, &requested_version, &requested);
+}
+
+void audio_pipeline_ctrl_set_bypass(uint8_t bypass_mask)
+{
+    taskENTER_CRITICAL();
+    audio_pipeline_ctrl_t next = requested;
+    next.bypass_mask = bypass_mask & AP_BYPASS_ALL;
+    ctrl_write(&requested, &requested_version, &next);
+    taskEXIT_CRITICAL();
+}
+
+uint8_t audio_pipeline_ctrl_get_bypass(void)
+{
+    audio_pipeline_ctrl_t settings;
+
+    audio_pipeline_ctrl_get_settings(&settings);
+    return settings.bypass_mask;
+}
+
+void audio_pipeline_ctrl_set_aec_profile(const audio_pipeline_aec_profile_t *profile)
+{
+    aec_profile = profile;
+
+    const uint8_t main_phases = aec_phases_default & 0xFF;
+    const uint8_t shadow_phases = aec_phases_default >> 8;
+    if (aec_phases_default != 0 && audio_pipeline_ctrl_set_aec_phases(main_phases, shadow_phases) != 0) {
+        rtos_printf("AEC filter phases %u, %u not supported\n", main_phases, shadow_phases);
+    }
+}
+
+void audio_pipeline_ctrl_set_default_aec_phases(uint8_t main_phases, uint8_t shadow_phases)
+{
+    aec_phases_default = main_phases | (shadow_phases << 8);
+}
+
+static uint32_t aec_cost_us(const audio_pipeline_aec_profile_t *profile,
+                            uint8_t main_phases,
+                            uint8_t shadow_phases)
+{
+    const uint32_t pairs = profile->num_y_channels * profile->num_x_channels;
+    const uint32_t cost = profile->cost_fixed_us +
+                          profile->cost_per_phase_us * pairs * (main_phases + shadow_phases);
+
+    return cost / profile->num_threads;
+}
+
+static int aec_phases_valid(uint8_t main_phases, uint8_t shadow_phases)
+{
+    const audio_pipeline_aec_profile_t *profile = aec_profile;
+
+    if (profile == NULL) {
+        return 0;
+    }
+
+    /* The shadow filter reads the main filter's X FIFO, so it can be no longer */
+    if (main_phases == 0 || main_phases > profile->max_main_phases ||
+        shadow_phases > profile->max_shadow_phases || shadow_phases > main_phases) {
+        return 0;
+    }
+
+    return aec_cost_us(profile, main_phases, shadow_phases) <= profile->budget_us;
+}
+
+static int mic_delay_valid(int32_t samples)
+{
+    return mic_delay_max != 0 && samples <= mic_delay_max && -samples <= mic_delay_max;
+}
+
+int audio_pipeline_ctrl_set_settings(const audio_pipeline_ctrl_t *settings)
+{
+    int ret = 0;
+
+    taskENTER_CRITICAL();
+
+    /* Only changed values are checked, as the build defaults may not be
+     * valid in pipelines that do not have the stage they are for */
+    audio_pipeline_ctrl_t next = requested;
+    next.bypass_mask = settings->bypass_mask & AP_BYPASS_ALL;
+    next.aec_main_phases = settings->aec_main_phases;
+    next.aec_shadow_phases = settings->aec_shadow_phases;
+    next.mic_delay_samples = settings->mic_delay_samples;
+
+    if ((next.aec_main_phases != requested.aec_main_phases ||
+         next.aec_shadow_phases != requested.aec_shadow_phases) &&
+        !aec_phases_valid(next.aec_main_phases, next.aec_shadow_phases)) {
+        ret = -1;
+    }
+    if (next.mic_delay_samples != requested.mic_delay_samples &&
+        !mic_delay_valid(next.mic_delay_samples)) {
+        ret = -1;
+    }
+    if (ret == 0) {
+        ctrl_write(&requested, &requested_version, &next);
+    }
+
+    taskEXIT_CRITICAL();
+    return ret;
+}
+
+int audio_pipeline_ctrl_set_aec_phases(uint8_t main_phases, uint8_t shadow_phases)
+{
+    if (!aec_phases_valid(main_phases, shadow_phases)) {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    audio_pipeline_ctrl_t next = requested;
+    next.aec_main_phases = main_phases;
+    next.aec_shadow_phases = shadow_phases;
+    ctrl_write(&requested, &requested_version, &next);
+    taskEXIT_CRITICAL();
+    return 0;
+}
+
+void audio_pipeline_ctrl_get_aec_phases(uint8_t *main_phases, uint8_t *shadow_phases)
+{
+    const audio_pipeline_aec_profile_t *profile = aec_profile;
+    audio_pipeline_ctrl_t settings;
+
+    audio_pipeline_ctrl_get_settings(&settings);
+    if (settings.aec_main_phases != 0) {
+        *main_phases = settings.aec_main_phases;
+        *shadow_phases = settings.aec_shadow_phases;
+    } else if (profile != NULL) {
+        *main_phases = profile->default_main_phases;
+        *shadow_phases = profile->default_shadow_phases;
+    } else {
+        *main_phases = 0;
+        *shadow_phases = 0;
+    }
+}
+
+void audio_pipeline_ctrl_set_mic_delay_limit(int32_t max_samples)
+{
+    mic_delay_max = max_samples;
+
+    if (audio_pipeline_ctrl_set_mic_delay(mic_delay_default) != 0) {
+        rtos_printf("mic delay %d not supported\n", (int) mic_delay_default);
+    }
+}
+
+int audio_pipeline_ctrl_set_mic_delay(int32_t samples)
+{
+    if (!mic_delay_valid(samples)) {
+        return -1;
+    }
+
+    taskENTER_CRITICAL();
+    audio_pipeline_ctrl_t next = requested;
+    next.mic_delay_samples = samples;
+    ctrl_write(&requested, &requested_version, &next);
+    taskEXIT_CRITICAL();
+    return 0;
+}
+
+void audio_pipeline_ctrl_set_default_mic_delay(int32_t samples)
+{
+    mic_delay_default = samples;
+}
+
+int32_t audio_pipeline_ctrl_get_mic_delay(void)
+{
+    audio_pipeline_ctrl_t settings;
+
+    audio_pipeline_ctrl_get_settings(&settings);
+    return (mic_delay_max > 0) ? settings.mic_delay_samples : 0;
+}
+
+void audio_pipeline_ctrl_set_input_status(const audio_pipeline_input_status_t *status)
+{
+    memcpy(&input_status, status, sizeof(input_status));
+}
+
+void audio_pipeline_ctrl_get_input_status(audio_pipeline_input_status_t *status)
+{
+    memcpy(status, &input_status, sizeof(input_status));
+}
+
+void audio_pipeline_ctrl_poll(rtos_intertile_t *ctx)
+{
+    audio_pipeline_ctrl_t next;
+    size_t len = rtos_intertile_rx_len(ctx, appconfAUDIOPIPELINE_CTRL_PORT, 0);
+
+    if (len == 0) {
+        return;
+    }
+
+    configASSERT(len == sizeof(next));
+    rtos_intertile_rx_data(ctx, &next, sizeof(next));
+    ctrl_write(&applied, &applied_version, &next);
+}
+
+void audio_pipeline_ctrl_get(audio_pipeline_ctrl_t *ctrl)
+{
+    ctrl_read(ctrl, &applied_version, &applied);
+}
@@ -0,0 +1,190 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef AUDIO_PIPELINE_CTRL_H_
+#define AUDIO_PIPELINE_CTRL_H_
+
+#include <stdint.h>
+#include "app_conf.h"
+#include "platform/driver_instances.h"
+#include "audio_pipeline.h"
+
+/* Stage bypass mask bits. A bypassed stage leaves the frame untouched */
+#define AP_BYPASS_STATIC_DELAY  (1 << 0)
+#define AP_BYPASS_AEC           (1 << 1)
+#define AP_BYPASS_IC_AND_VNR    (1 << 2)
+#define AP_BYPASS_NS            (1 << 3)
+#define AP_BYPASS_AGC           (1 << 4)
+#define AP_BYPASS_ALL           (0x1F)
+
+/* Bypass mask at boot, from the appconfAUDIO_PIPELINE_SKIP_* build options */
+#define AP_BYPASS_DEFAULT                                                   \
+    ((appconfAUDIO_PIPELINE_SKIP_STATIC_DELAY ? AP_BYPASS_STATIC_DELAY : 0) | \
+     (appconfAUDIO_PIPELINE_SKIP_AEC ? AP_BYPASS_AEC : 0) |                   \
+     (appconfAUDIO_PIPELINE_SKIP_IC_AND_VNR ? AP_BYPASS_IC_AND_VNR : 0) |     \
+     (appconfAUDIO_PIPELINE_SKIP_NS ? AP_BYPASS_NS : 0) |                     \
+     (appconfAUDIO_PIPELINE_SKIP_AGC ? AP_BYPASS_AGC : 0))
+
+/* Mic delay at boot, in samples. Positive delays the mics, negative the reference */
+#define AP_MIC_DELAY_DEFAULT    (appconfINPUT_SAMPLES_MIC_DELAY_MS * (appconfAUDIO_PIPELINE_SAMPLE_RATE / 1000))
+
+/*
+ * Control back-channel from the tile 0 half of a pipeline to the tile 1
+ * half. Tile 0 builds a message from its current settings once per frame
+ * and sends it on appconfAUDIOPIPELINE_CTRL_PORT only when it changes.
+ * Tile 1 polls for it without blocking once per frame, and echoes the
+ * sequence number of the message it applied in each frame's wire header.
+ */
+typedef struct {
+    uint8_t seq;
+    uint8_t channel_mask;   /* Channels tile 0 needs from tile 1 */
+    uint8_t wire_format;    /* One of AP_WIRE_FORMAT_* */
+    uint8_t bypass_mask;    /* AP_BYPASS_* stages to skip */
+    uint8_t aec_main_phases;    /* AEC filter length, 0 for the pipeline's default */
+    uint8_t aec_shadow_phases;
+    int16_t mic_delay_samples;  /* Static delay, in pipelines that have one */
+} audio_pipeline_ctrl_t;
+
+/*
+ * What a pipeline's AEC can run, registered on tile 0 by pipelines that
+ * have one. Used to check filter lengths before they are sent to tile 1.
+ * The cost figures model the time the AEC takes per frame on one thread.
+ */
+typedef struct {
+    uint8_t num_y_channels;
+    uint8_t num_x_channels;
+    uint8_t default_main_phases;
+    uint8_t default_shadow_phases;
+    uint8_t max_main_phases;    /* Most the memory pools hold at these channel counts */
+    uint8_t max_shadow_phases;
+    uint8_t num_threads;
+    uint32_t budget_us;         /* Time the AEC may take per frame */
+    uint32_t cost_fixed_us;
+    uint32_t cost_per_phase_us; /* Per phase, per y/x channel pair, either filter */
+} audio_pipeline_aec_profile_t;
+
+/**
+ * Called by the tile 0 pipeline output once per frame. Sends a control
+ * message to tile 1 if any setting differs from the last one sent. Must
+ * not be called from the task that receives frames from tile 1.
+ *
+ * \param settings  from audio_pipeline_ctrl_get_settings(), the same copy
+ *                  that channel_mask was worked out for
+ */
+void audio_pipeline_ctrl_sync(rtos_intertile_t *ctx, uint8_t channel_mask, const audio_pipeline_ctrl_t *settings);
+
+/**
+ * Copies the settings last set on tile 0, all as of the same moment. Only
+ * the bypass mask, AEC phases and mic delay are filled in. The AEC phases
+ * are 0 if none were set.
+ */
+void audio_pipeline_ctrl_get_settings(audio_pipeline_ctrl_t *settings);
+
+/**
+ * Sets the bypass mask, AEC phases and mic delay together, so that tile 1
+ * applies them in the same frame. Called on tile 0 from any task, with
+ * settings from audio_pipeline_ctrl_get_settings() changed as needed. The
+ * values that changed are checked as the setters below check them.
+ *
+ * \returns 0 on success, or -1 with no setting changed if any is rejected
+ */
+int audio_pipeline_ctrl_set_settings(const audio_pipeline_ctrl_t *settings);
+
+/**
+ * Sets the stages to bypass. Called on tile 0 from any task, for example
+ * the configuration servicer. Takes effect on tile 1 within a frame or two,
+ * and on both tiles for the same frame.
+ */
+void audio_pipeline_ctrl_set_bypass(uint8_t bypass_mask);
+
+/**
+ * Returns the bypass mask last set on tile 0. Pipeline stages must use the
+ * mask carried in their frame instead, which is consistent across tiles.
+ */
+uint8_t audio_pipeline_ctrl_get_bypass(void);
+
+/**
+ * Registers the AEC of the tile 0 pipeline's other half. Called once from
+ * the tile 0 pipeline init. profile must stay valid.
+ */
+void audio_pipeline_ctrl_set_aec_profile(const audio_pipeline_aec_profile_t *profile);
+
+/**
+ * Sets the AEC filter length. Called on tile 0 from any task. Tile 1
+ * re-initialises the AEC with it, which restarts adaption.
+ *
+ * \returns 0 on success, -1 if the pipeline has no AEC, the pools cannot
+ *          hold the filters, or the estimated time per frame is over the
+ *          pipeline's budget. The filter length is unchanged on failure.
+ */
+int audio_pipeline_ctrl_set_aec_phases(uint8_t main_phases, uint8_t shadow_phases);
+
+/**
+ * Gets the AEC filter length last set on tile 0, or the pipeline's default
+ * if none was set. Both are 0 if the pipeline has no AEC.
+ */
+void audio_pipeline_ctrl_get_aec_phases(uint8_t *main_phases, uint8_t *shadow_phases);
+
+/**
+ * Sets the AEC filter length the pipeline starts with, in place of its
+ * default. Called on tile 0 before audio_pipeline_init(). It is checked as
+ * audio_pipeline_ctrl_set_aec_phases() checks it when the pipeline registers
+ * its AEC, and dropped with a message if it fails.
+ */
+void audio_pipeline_ctrl_set_default_aec_phases(uint8_t main_phases, uint8_t shadow_phases);
+
+/**
+ * Sets the longest mic delay, either way, that audio_pipeline_ctrl_set_mic_delay()
+ * accepts. Called once from the tile 0 init of pipelines with a static delay.
+ */
+void audio_pipeline_ctrl_set_mic_delay_limit(int32_t max_samples);
+
+/**
+ * Sets the static delay between the mics and the reference. Called on
+ * tile 0 from any task. Positive values delay the mics, negative values
+ * the reference. The audio buffered before the change is dropped.
+ *
+ * \returns 0 on success, -1 if the pipeline has no static delay or the
+ *          delay is over its limit. The delay is unchanged on failure.
+ */
+int audio_pipeline_ctrl_set_mic_delay(int32_t samples);
+
+/**
+ * Sets the static delay the pipeline starts with, in place of
+ * AP_MIC_DELAY_DEFAULT. Called on tile 0 before audio_pipeline_init(). It is
+ * checked as audio_pipeline_ctrl_set_mic_delay() checks it when the pipeline
+ * registers its limit, and dropped with a message if it fails.
+ */
+void audio_pipeline_ctrl_set_default_mic_delay(int32_t samples);
+
+/**
+ * Returns the static delay last set on tile 0, or 0 if the pipeline has
+ * no static delay.
+ */
+int32_t audio_pipeline_ctrl_get_mic_delay(void);
+
+/**
+ * Stores the input status carried by a frame from tile 1. Called by the
+ * tile 0 pipeline input once per frame.
+ */
+void audio_pipeline_ctrl_set_input_status(const audio_pipeline_input_status_t *status);
+
+/**
+ * Copies the input status of the last frame received on tile 0, or zeros
+ * if the pipeline does not carry it.
+ */
+void audio_pipeline_ctrl_get_input_status(audio_pipeline_input_status_t *status);
+
+/**
+ * Called by the tile 1 pipeline input once per frame. Applies a control
+ * message if one has arrived.
+ */
+void audio_pipeline_ctrl_poll(rtos_intertile_t *ctx);
+
+/**
+ * Copies the settings last applied on tile 1. Safe to call from any tile 1
+ * pipeline stage.
+ */
+void audio_pipeline_ctrl_get(audio_pipeline_ctrl_t *ctrl);
+
+#endif /* AUDIO_PIPELINE_CTRL_H_ */
@@ -0,0 +1,167 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+
+/* App headers */
+#include "app_conf.h"
+#include "platform/driver_instances.h"
+#include "audio_pipeline_wire.h"
+#include "pcm16.h"
+
+typedef struct {
+    ap_wire_ch16_t hdr;
+    int16_t samples[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
+} ap_wire_block16_t;
+
+static size_t ap_wire_channel_bytes(uint8_t format, size_t frame_advance)
+{
+    if (format == AP_WIRE_FORMAT_S32) {
+        return frame_advance * sizeof(int32_t);
+    }
+    return sizeof(ap_wire_ch16_t) + frame_advance * sizeof(int16_t);
+}
+
+size_t ap_wire_frame_bytes(uint8_t format,
+                           uint8_t channel_mask,
+                           size_t metadata_bytes,
+                           size_t frame_advance)
+{
+    return sizeof(ap_wire_header_t) + metadata_bytes +
+           __builtin_popcount(channel_mask) * ap_wire_channel_bytes(format, frame_advance);
+}
+
+static void ap_wire_pack16(ap_wire_block16_t *block, uint8_t format, const int32_t *src, size_t n)
+{
+    if (format == AP_WIRE_FORMAT_S16) {
+        block->hdr.shift = 16;
+        pcm16_from_s32(block->samples, src, n, PCM16_GAIN_UNITY);
+        return;
+    }
+
+    /* Smallest shift that fits the largest magnitude into 16 bits */
+    uint32_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+        m |= (uint32_t) (src[i] < 0 ? ~src[i] : src[i]);
+    }
+    const int bits = m ? 33 - __builtin_clz(m) : 1;
+    const int shift = bits > 16 ? bits - 16 : 0;
+
+    block->hdr.shift = shift;
+    for (size_t i = 0; i < n; i++) {
+        block->samples[i] = (int16_t) (src[i] >> shift);
+    }
+}
+
+static void ap_wire_unpack16(int32_t *dst, const ap_wire_ch16_t *hdr, const int16_t *src, size_t n)
+{
+    const int shift = hdr->shift;
+
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = (int32_t) ((uint32_t) (int32_t) src[i] << shift);
+    }
+}
+
+void ap_wire_send(rtos_intertile_t *ctx,
+                  uint8_t port,
+                  uint8_t format,
+                  uint8_t channel_mask,
+                  uint8_t ctrl_seq,
+                  const void *metadata,
+                  size_t metadata_bytes,
+                  const int32_t *channels,
+                  size_t channel_count,
+                  size_t frame_advance)
+{
+    ap_wire_header_t header = {
+        .version = AP_WIRE_VERSION,
+        .format = format,
+        .channel_mask = channel_mask & ((1 << channel_count) - 1),
+        .ctrl_seq = ctrl_seq,
+        .frame_advance = frame_advance,
+        .metadata_bytes = metadata_bytes,
+    };
+
+    configASSERT(channel_count <= AP_WIRE_MAX_CHANNELS);
+    configASSERT(frame_advance <= appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    configASSERT((metadata_bytes % sizeof(int32_t)) == 0); /* Keeps the channel blocks word aligned */
+
+    rtos_intertile_tx_len(ctx, port, ap_wire_frame_bytes(format, header.channel_mask, metadata_bytes, frame_advance));
+    rtos_intertile_tx_data(ctx, &header, sizeof(header));
+    if (metadata_bytes > 0) {
+        rtos_intertile_tx_data(ctx, (void *) metadata, metadata_bytes);
+    }
+
+    for (size_t ch = 0; ch < channel_count; ch++) {
+        if (!(header.channel_mask & AP_WIRE_CH(ch))) {
+            continue;
+        }
+
+        const int32_t *src = channels + ch * frame_advance;
+        if (format == AP_WIRE_FORMAT_S32) {
+            rtos_intertile_tx_data(ctx, (void *) src, frame_advance * sizeof(int32_t));
+        } else {
+            ap_wire_block16_t block;
+            ap_wire_pack16(&block, format, src, frame_advance);
+            rtos_intertile_tx_data(ctx, &block, ap_wire_channel_bytes(format, frame_advance));
+        }
+    }
+}
+
+int ap_wire_recv(rtos_intertile_t *ctx,
+                 uint8_t port,
+                 void *buf,
+                 size_t buf_size,
+                 ap_wire_header_t *header,
+                 void *metadata,
+                 size_t metadata_bytes,
+                 int32_t *channels,
+                 size_t channel_count,
+                 size_t frame_advance)
+{
+    size_t len = rtos_intertile_rx_len(ctx, port, portMAX_DELAY);
+
+    configASSERT(len <= buf_size);
+    rtos_intertile_rx_data(ctx, buf, len);
+
+    if (len < sizeof(ap_wire_header_t)) {
+        return -1;
+    }
+
+    const uint8_t *p = buf;
+    memcpy(header, p, sizeof(ap_wire_header_t));
+    p += sizeof(ap_wire_header_t);
+
+    if (header->version != AP_WIRE_VERSION ||
+        header->frame_advance != frame_advance ||
+        header->metadata_bytes != metadata_bytes ||
+        len != ap_wire_frame_bytes(header->format, header->channel_mask, metadata_bytes, frame_advance)) {
+        return -1;
+    }
+
+    memcpy(metadata, p, metadata_bytes);
+    p += metadata_bytes;
+
+    for (size_t ch = 0; ch < channel_count; ch++) {
+        int32_t *dst = channels + ch * frame_advance;
+
+        if (!(header->channel_mask & AP_WIRE_CH(ch))) {
+            memset(dst, 0x00, frame_advance * sizeof(int32_t));
+        } else if (header->format == AP_WIRE_FORMAT_S32) {
+            memcpy(dst, p, frame_advance * sizeof(int32_t));
+            p += frame_advance * sizeof(int32_t);
+        } else {
+            ap_wire_ch16_t ch_hdr;
+            memcpy(&ch_hdr, p, sizeof(ch_hdr));
+            ap_wire_unpack16(dst, &ch_hdr, (const int16_t *) (p + sizeof(ch_hdr)), frame_advance);
+            p += ap_wire_channel_bytes(header->format, frame_advance);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef AUDIO_PIPELINE_WIRE_H_
+#define AUDIO_PIPELINE_WIRE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "app_conf.h"
+#include "platform/driver_instances.h"
+
+/*
+ * Packed format for frames crossing the intertile link between the two
+ * halves of a pipeline. A frame is sent as:
+ *
+ *   ap_wire_header_t
+ *   metadata_bytes of pipeline specific metadata
+ *   one block per channel set in channel_mask, in channel order
+ *
+ * A channel block is frame_advance int32_t for AP_WIRE_FORMAT_S32. For the
+ * 16 bit formats it is an ap_wire_ch16_t holding the shift the samples were
+ * scaled down by, followed by frame_advance int16_t.
+ */
+
+#define AP_WIRE_VERSION         (1)
+
+#define AP_WIRE_FORMAT_S32      (0) /* Lossless */
+#define AP_WIRE_FORMAT_S16      (1) /* Top 16 bits of each sample, rounded and saturated */
+#define AP_WIRE_FORMAT_BFP16    (2) /* 16 bit mantissas, one exponent per channel */
+
+#ifndef appconfAUDIO_PIPELINE_WIRE_FORMAT
+#define appconfAUDIO_PIPELINE_WIRE_FORMAT AP_WIRE_FORMAT_S32
+#endif
+
+#define AP_WIRE_MAX_CHANNELS    (8)
+#define AP_WIRE_CH(n)           (1 << (n))
+
+typedef struct {
+    uint8_t version;
+    uint8_t format;
+    uint8_t channel_mask;
+    uint8_t ctrl_seq;       /* Sequence number of the last control message applied by the sender */
+    uint16_t frame_advance;
+    uint16_t metadata_bytes;
+} ap_wire_header_t;
+
+typedef struct {
+    int8_t shift;
+    uint8_t reserved[3];
+} ap_wire_ch16_t;
+
+/* Size of a frame on the wire, including the header */
+size_t ap_wire_frame_bytes(uint8_t format,
+                           uint8_t channel_mask,
+                           size_t metadata_bytes,
+                           size_t frame_advance);
+
+/* Largest frame that can arrive with channel_count channels */
+#define AP_WIRE_MAX_FRAME_BYTES(metadata_bytes, channel_count, frame_advance) \
+    (sizeof(ap_wire_header_t) + (metadata_bytes) + (channel_count) * (frame_advance) * sizeof(int32_t))
+
+/**
+ * Sends one frame. The header, metadata and each S32 channel are sent
+ * straight from the caller's memory, without staging the whole frame. 16 bit
+ * channels are converted one at a time.
+ *
+ * \param channels       channel_count rows of frame_advance samples,
+ *                       stored contiguously
+ */
+void ap_wire_send(rtos_intertile_t *ctx,
+                  uint8_t port,
+                  uint8_t format,
+                  uint8_t channel_mask,
+                  uint8_t ctrl_seq,
+                  const void *metadata,
+                  size_t metadata_bytes,
+                  const int32_t *channels,
+                  size_t channel_count,
+                  size_t frame_advance);
+
+/**
+ * Receives one frame into buf, then unpacks it into metadata and channels.
+ * Channels not present on the wire are zeroed.
+ *
+ * \returns 0 on success, or -1 if the frame does not match the expected
+ *          version, metadata size or frame advance.
+ */
+int ap_wire_recv(rtos_intertile_t *ctx,
+                 uint8_t port,
+                 void *buf,
+                 size_t buf_size,
+                 ap_wire_header_t *header,
+                 void *metadata,
+                 size_t metadata_bytes,
+                 int32_t *channels,
+                 size_t channel_count,
+                 size_t frame_advance);
+
+#endif /* AUDIO_PIPELINE_WIRE_H_ */
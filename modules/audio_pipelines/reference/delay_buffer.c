@@ -0,0 +1,69 @@
+// Copyright 2022-2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <stdint.h>
+#include <string.h>
+#include "audio_pipeline_dsp.h"
+#include "delay_buffer.h"
+
+// Brings an index that is at most one buffer length out of range back into the buffer
+static inline int32_t wrap_idx(int32_t idx) {
+    if (idx < 0) {
+        idx += DELAY_BUF_LENGTH;
+    } else if (idx >= DELAY_BUF_LENGTH) {
+        idx -= DELAY_BUF_LENGTH;
+    }
+    return idx;
+}
+
+// Number of samples from idx that can be accessed before the buffer wraps
+static inline int32_t span_len(int32_t idx, int32_t num_samples) {
+    int32_t len = DELAY_BUF_LENGTH - idx;
+    return (len < num_samples) ? len : num_samples;
+}
+
+static inline int32_t abs_delay(const delay_buf_state_t *delay_state) {
+    return (delay_state->delay_samples < 0) ? -delay_state->delay_samples : delay_state->delay_samples;
+}
+
+void delay_buffer_init(delay_buf_state_t *state, int default_delay_samples) {
+    memset(state->delay_buffer, 0, sizeof(state->delay_buffer));
+    memset(&state->curr_idx[0], 0, sizeof(state->curr_idx));
+    state->delay_samples = default_delay_samples;
+}
+
+void get_delayed_samples(delay_buf_state_t *delay_state, int32_t *samples, int32_t ch, int32_t num_samples) {
+    int32_t *buf = delay_state->delay_buffer[ch];
+    int32_t curr_idx = delay_state->curr_idx[ch];
+
+    // Store the new samples, then send back the ones from delay_samples earlier. Each is
+    // at most two copies, split where the buffer wraps.
+    int32_t len = span_len(curr_idx, num_samples);
+    memcpy(&buf[curr_idx], &samples[0], len*sizeof(int32_t));
+    memcpy(&buf[0], &samples[len], (num_samples - len)*sizeof(int32_t));
+
+    int32_t delay_idx = wrap_idx(curr_idx - abs_delay(delay_state));
+    len = span_len(delay_idx, num_samples);
+    memcpy(&samples[0], &buf[delay_idx], len*sizeof(int32_t));
+    memcpy(&samples[len], &buf[0], (num_samples - len)*sizeof(int32_t));
+
+    delay_state->curr_idx[ch] = wrap_idx(curr_idx + num_samples);
+}
+
+void update_delay_samples(delay_buf_state_t *delay_state, int32_t num_samples) {
+    delay_state->delay_samples = num_samples;
+}
+
+void reset_partial_delay_buffer(delay_buf_state_t *delay_state, int32_t ch) {
+    int32_t num_samples = abs_delay(delay_state);
+    if(!num_samples) {
+        return;
+    }
+
+    // Reset num_samples samples before curr_idx
+    int32_t *buf = delay_state->delay_buffer[ch];
+    int32_t reset_start = wrap_idx(delay_state->curr_idx[ch] - num_samples);
+    int32_t len = span_len(reset_start, num_samples);
+    memset(&buf[reset_start], 0, len*sizeof(int32_t));
+    memset(&buf[0], 0, (num_samples - len)*sizeof(int32_t));
+}
@@ -0,0 +1,33 @@
+// Copyright 2022-2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef DELAY_BUFFER_H_
+#define DELAY_BUFFER_H_
+#include "audio_pipeline_dsp.h"
+
+/*
+ * Delay line shared by the pipelines that delay the mics or the reference.
+ * Sized by MAX_DELAY_BUF_CHANNELS and DELAY_BUF_MAX_DELAY_SAMPLES from the
+ * pipeline's audio_pipeline_dsp.h. Not thread safe: the delay is changed by
+ * the stage that runs the buffer.
+ */
+
+// A frame of headroom lets a whole frame be stored before the delayed one is read back
+#define DELAY_BUF_LENGTH    (DELAY_BUF_MAX_DELAY_SAMPLES + AP_FRAME_ADVANCE)
+
+typedef struct {
+    // Circular buffer to store the samples
+    int32_t delay_buffer[MAX_DELAY_BUF_CHANNELS][DELAY_BUF_LENGTH];
+    // index of the value for the samples to be stored in the buffer
+    int32_t curr_idx[MAX_DELAY_BUF_CHANNELS];
+    // Up to DELAY_BUF_MAX_DELAY_SAMPLES either way
+    int32_t delay_samples;
+} delay_buf_state_t;
+
+void delay_buffer_init(delay_buf_state_t *state, int default_delay_samples);
+// Delays num_samples samples of channel ch in place. num_samples can be at most AP_FRAME_ADVANCE
+void get_delayed_samples(delay_buf_state_t *delay_state, int32_t *samples, int32_t ch, int32_t num_samples);
+void update_delay_samples(delay_buf_state_t *delay_state, int32_t num_samples);
+void reset_partial_delay_buffer(delay_buf_state_t *delay_state, int32_t ch);
+
+#endif /* DELAY_BUFFER_H_ */
@@ -5,9 +5,13 @@
 #define AUDIO_PIPELINE_DSP_H_
 
 #include <stdint.h>
+#include <stddef.h>
 #include "FreeRTOS.h"
-#include "stream_buffer.h"
 #include "app_conf.h"
+#include "stage_profiler.h"
+#include "pipeline_telemetry.h"
+#include "audio_pipeline_ctrl.h"
+#include "audio_pipeline.h"
 #include <stdint.h>
 
 /* Pipeline config */
@@ -21,13 +25,43 @@
 #define AEC_MAIN_FILTER_PHASES    (10)
 #define AEC_SHADOW_FILTER_PHASES    (5)
 
-/* Delay buffer config */
+/* Phases the memory pools are sized for. The filter length can be changed at run time within these */
+#ifndef AEC_MAX_MAIN_FILTER_PHASES
+#define AEC_MAX_MAIN_FILTER_PHASES    (15)
+#endif
+#ifndef AEC_MAX_SHADOW_FILTER_PHASES
+#define AEC_MAX_SHADOW_FILTER_PHASES    (AEC_SHADOW_FILTER_PHASES)
+#endif
+
+/* Most phases the pools hold when the AEC runs with fewer than the maximum channels */
+#define AEC_POOL_MAIN_FILTER_PHASES(y, x)   (((AEC_MAX_Y_CHANNELS * AEC_MAX_X_CHANNELS) + AEC_MAX_X_CHANNELS) * AEC_MAX_MAIN_FILTER_PHASES / (((y) * (x)) + (x)))
+#define AEC_POOL_SHADOW_FILTER_PHASES(y, x) ((AEC_MAX_Y_CHANNELS * AEC_MAX_X_CHANNELS) * AEC_MAX_SHADOW_FILTER_PHASES / ((y) * (x)))
+
+/* Cost model for run time filter length changes, see audio_pipeline_aec_profile_t.
+ * Estimates for one thread, re-measure with the STAGE_PROFILE servicer command */
+#define AEC_BUDGET_US               (13500) /* 90% of the frame, the AEC has a stage to itself */
+#define AEC_COST_FIXED_US           (2000)
+#define AEC_COST_PER_PHASE_US       (150)
+
+/* Hardware threads the AEC runs on, 1 or 2. With 2, a helper task takes half the work of each frame */
+#ifndef NUM_AEC_THREADS
+#define NUM_AEC_THREADS (2)
+#endif
+
+/* Delay buffer config. The delay can be changed at run time up to DELAY_BUF_MAX_DELAY_MS either way */
 #define MAX_DELAY_BUF_CHANNELS (2)
+#ifndef DELAY_BUF_MAX_DELAY_MS
 #define DELAY_BUF_MAX_DELAY_MS                ( 150 )
+#endif
 #define DELAY_BUF_MAX_DELAY_SAMPLES           ( 16000*DELAY_BUF_MAX_DELAY_MS/1000 )
 
+#if (appconfINPUT_SAMPLES_MIC_DELAY_MS > DELAY_BUF_MAX_DELAY_MS) || (-appconfINPUT_SAMPLES_MIC_DELAY_MS > DELAY_BUF_MAX_DELAY_MS)
+#error appconfINPUT_SAMPLES_MIC_DELAY_MS is longer than the delay buffer
+#endif
+
 #include "aec_api.h"
 #include "aec/aec_memory_pool.h"
+#include "delay_buffer.h"
 #include "agc_api.h"
 #include "ic_api.h"
 #include "ns_api.h"
@@ -43,15 +77,35 @@ typedef struct {
     int32_t aec_reference_audio_samples[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     int32_t mic_samples_passthrough[appconfAUDIO_PIPELINE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
 
+    /* Filled in by the tile 0 stages and published by the output, not sent between tiles */
+    pipeline_telemetry_t telemetry;
+
     /* Below is additional context needed by other stages on a per frame basis */
     int32_t vnr_pred_flag;
     float_s32_t max_ref_energy;
     float_s32_t aec_corr_factor;
     int32_t ref_active_flag;
+
+    /* Settings from tile 0 that this frame is processed with, latched on tile 1 */
+    audio_pipeline_ctrl_t ctrl;
+
+    /* Tile 1 stage timings, reported by the tile 0 configuration servicer */
+    stage_profiler_snapshot_t stage_profile;
+
+    /* State of the app's input on tile 1, reported by the tile 0 configuration servicer */
+    audio_pipeline_input_status_t input_status;
 } frame_data_t;
 
+/* Everything after the audio, sent between tiles alongside the channels */
+#define AP_FRAME_METADATA(frame_data)   (&(frame_data)->vnr_pred_flag)
+#define AP_FRAME_METADATA_BYTES         (sizeof(frame_data_t) - offsetof(frame_data_t, vnr_pred_flag))
+
+/* Channels in frame_data_t, in audio_pipeline_output() order */
+#define AP_FRAME_CHANNELS               (3 * appconfAUDIO_PIPELINE_CHANNELS)
+
 typedef struct stage_delay_ctx {
-    StreamBufferHandle_t delay_buf;
+    delay_buf_state_t DWORD_ALIGNED delay_state;
+    int bypassed;
 } stage_delay_ctx_t;
 
 typedef struct aec_ctx {
@@ -79,19 +133,6 @@ typedef struct agc_stage_ctx {
     agc_state_t DWORD_ALIGNED state;
 } agc_stage_ctx_t;
 
-/**
- * Delay buffer contains the configured buffer delay size + 1 frame worth of audio
- * When appconfINPUT_SAMPLES_MIC_DELAY_MS  is positive, the mic is delayed
- * When appconfINPUT_SAMPLES_MIC_DELAY_MS is negative, the mic is "advanced" by delaying ref
- */
-#define ABS(A) ((A >= 0) ? A : -A)
-#define AP_INPUT_SAMPLES_MIC_DELAY_SIZE_PER_CHAN        ( 16000*ABS(appconfINPUT_SAMPLES_MIC_DELAY_MS)/1000 )
-#define AP_INPUT_SAMPLES_MIC_DELAY_CHAN_CNT             ( (appconfINPUT_SAMPLES_MIC_DELAY_MS > 0) ? AEC_MAX_Y_CHANNELS : AEC_MAX_X_CHANNELS )
-#define AP_INPUT_SAMPLES_MIC_DELAY_SIZE_CHAN            ( AP_INPUT_SAMPLES_MIC_DELAY_SIZE_PER_CHAN * AP_INPUT_SAMPLES_MIC_DELAY_CHAN_CNT )
-#define AP_INPUT_SAMPLES_MIC_DELAY_SIZE_CUR_FRAME_WORDS ( AP_INPUT_SAMPLES_MIC_DELAY_CHAN_CNT * appconfAUDIO_PIPELINE_FRAME_ADVANCE)
-#define AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES      ( AP_INPUT_SAMPLES_MIC_DELAY_SIZE_CUR_FRAME_WORDS * sizeof(int32_t))
-#define AP_INPUT_SAMPLES_MIC_DELAY_BUF_SIZE_BYTES       ( AP_INPUT_SAMPLES_MIC_DELAY_SIZE_CHAN * sizeof(int32_t) )
-
 void aec_process_frame_1thread(
         aec_state_t *main_state,
         aec_state_t *shadow_state,
@@ -100,4 +141,14 @@ void aec_process_frame_1thread(
         const int32_t (*y_data)[AEC_FRAME_ADVANCE],
         const int32_t (*x_data)[AEC_FRAME_ADVANCE]);
 
+void aec_process_frame_2threads_init(UBaseType_t priority);
+
+void aec_process_frame_2threads(
+        aec_state_t *main_state,
+        aec_state_t *shadow_state,
+        int32_t (*output_main)[AEC_FRAME_ADVANCE],
+        int32_t (*output_shadow)[AEC_FRAME_ADVANCE],
+        const int32_t (*y_data)[AEC_FRAME_ADVANCE],
+        const int32_t (*x_data)[AEC_FRAME_ADVANCE]);
+
 #endif /* AUDIO_PIPELINE_DSP_H_ */
@@ -26,6 +26,11 @@
 #include "app_conf.h"
 #include "audio_pipeline.h"
 #include "audio_pipeline_dsp.h"
+#include "stage_profiler.h"
+#include "pipeline_telemetry.h"
+#include "frame_pool.h"
+#include "audio_pipeline_wire.h"
+#include "audio_pipeline_ctrl.h"
 
 /* configuration servicer */
 #include "configuration_servicer.h"
@@ -34,33 +39,65 @@
 #error This pipeline is only configured for 240 frame advance
 #endif
 
+#define AUDIO_PIPELINE_STAGE_COUNT (3)
+
 #define VNR_AGC_THRESHOLD (0.5)
 
+/* Channels read by the tile 0 stages: both AEC outputs */
+#define TILE0_INPUT_CHANNELS    (AP_WIRE_CH(0) | AP_WIRE_CH(1))
+
+/* Channels the tile 0 stages overwrite: IC and NS store their outputs in the reference channels */
+#define TILE0_OUTPUT_CHANNELS(bypass)                                   \
+    ((((bypass) & AP_BYPASS_IC_AND_VNR) ? 0 : AP_WIRE_CH(2)) |          \
+     (((bypass) & AP_BYPASS_NS) ? 0 : AP_WIRE_CH(3)))
+
 #if ON_TILE(0)
 static ic_stage_ctx_t DWORD_ALIGNED ic_stage_state = {};
 static vnr_pred_stage_ctx_t DWORD_ALIGNED vnr_pred_stage_state = {};
 static ns_stage_ctx_t DWORD_ALIGNED ns_stage_state = {};
 static agc_stage_ctx_t DWORD_ALIGNED agc_stage_state = {};
+static frame_data_t DWORD_ALIGNED frame_pool_storage[FRAME_POOL_DEPTH(AUDIO_PIPELINE_STAGE_COUNT)];
+static frame_pool_t frame_pool;
+static uint8_t DWORD_ALIGNED wire_buf[AP_WIRE_MAX_FRAME_BYTES(AP_FRAME_METADATA_BYTES, AP_FRAME_CHANNELS, appconfAUDIO_PIPELINE_FRAME_ADVANCE)];
+
+static const audio_pipeline_aec_profile_t aec_profile = {
+    .num_y_channels = AEC_MAX_Y_CHANNELS,
+    .num_x_channels = AEC_MAX_X_CHANNELS,
+    .default_main_phases = AEC_MAIN_FILTER_PHASES,
+    .default_shadow_phases = AEC_SHADOW_FILTER_PHASES,
+    .max_main_phases = AEC_POOL_MAIN_FILTER_PHASES(AEC_MAX_Y_CHANNELS, AEC_MAX_X_CHANNELS),
+    .max_shadow_phases = AEC_POOL_SHADOW_FILTER_PHASES(AEC_MAX_Y_CHANNELS, AEC_MAX_X_CHANNELS),
+    .num_threads = NUM_AEC_THREADS,
+    .budget_us = AEC_BUDGET_US,
+    .cost_fixed_us = AEC_COST_FIXED_US,
+    .cost_per_phase_us = AEC_COST_PER_PHASE_US,
+};
 
 static void *audio_pipeline_input_i(void *input_app_data)
 {
     frame_data_t *frame_data;
 
-    frame_data = pvPortMalloc(sizeof(frame_data_t));
-    memset(frame_data, 0x00, sizeof(frame_data_t));
+    /* The whole frame is overwritten by the intertile receive, so it is not cleared.
+     * Channels tile 1 did not send are zeroed. */
+    frame_data = frame_pool_acquire(&frame_pool);
 
-    size_t bytes_received = 0;
-    bytes_received = rtos_intertile_rx_len(
-            intertile_ctx,
-            appconfAUDIOPIPELINE_PORT,
-            portMAX_DELAY);
+    ap_wire_header_t header;
+    int ret = ap_wire_recv(intertile_ctx,
+                           appconfAUDIOPIPELINE_PORT,
+                           wire_buf,
+                           sizeof(wire_buf),
+                           &header,
+                           AP_FRAME_METADATA(frame_data),
+                           AP_FRAME_METADATA_BYTES,
+                           &frame_data->samples[0][0],
+                           AP_FRAME_CHANNELS,
+                           appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
-    xassert(bytes_received == sizeof(frame_data_t));
+    xassert(ret == 0);
 
-    rtos_intertile_rx_data(
-            intertile_ctx,
-            frame_data,
-            bytes_received);
+    pipeline_telemetry_clear(&frame_data->telemetry);
+    stage_profiler_set_remote(&frame_data->stage_profile);
+    audio_pipeline_ctrl_set_input_status(&frame_data->input_status);
 
     return frame_data;
 }
@@ -68,16 +105,34 @@ static void *audio_pipeline_input_i(void *input_app_data)
 static int audio_pipeline_output_i(frame_data_t *frame_data,
                                    void *output_app_data)
 {
-    return audio_pipeline_output(output_app_data,
+    /* Ask tile 1 for the settings and for what the app and the tile 0 stages will read */
+    audio_pipeline_ctrl_t settings;
+    audio_pipeline_ctrl_get_settings(&settings);
+    uint32_t channels = audio_pipeline_output_channels(output_app_data);
+    channels = (channels & ~TILE0_OUTPUT_CHANNELS(settings.bypass_mask)) | TILE0_INPUT_CHANNELS;
+    audio_pipeline_ctrl_sync(intertile_ctx, channels, &settings);
+
+    pipeline_telemetry_publish(&frame_data->telemetry,
+                               frame_data->max_ref_energy,
+                               frame_data->aec_corr_factor,
+                               frame_data->ref_active_flag,
+                               frame_data->vnr_pred_flag);
+
+    /* The frame always goes back to the pool, the app must not keep it */
+    (void) audio_pipeline_output(output_app_data,
                                (int32_t **)frame_data->samples,
                                6,
                                appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    frame_pool_release(&frame_pool, frame_data);
+    return AUDIO_PIPELINE_DONT_FREE_FRAME;
 }
 
 static void stage_vnr_and_ic(frame_data_t *frame_data)
 {
-#if appconfAUDIO_PIPELINE_SKIP_IC_AND_VAD
-#else
+    if (frame_data->ctrl.bypass_mask & AP_BYPASS_IC_AND_VNR) {
+        return;
+    }
+
     int32_t DWORD_ALIGNED ic_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     // tile 0 pipeline, frame_data->samples[0] is mic0(Modified during call) and frame_data->samples[1] is mic1
     // The performance of this filter has been optimised for a 71mm mic separation distance.
@@ -89,6 +144,7 @@ static void stage_vnr_and_ic(frame_data_t *frame_data)
 
     vnr_pred_state_t *vnr_pred_state = &vnr_pred_stage_state.vnr_pred_state;
     ic_calc_vnr_pred(&ic_stage_state.state, &vnr_pred_state->input_vnr_pred, &vnr_pred_state->output_vnr_pred);
+    pipeline_telemetry_set_vnr(&frame_data->telemetry, vnr_pred_state->input_vnr_pred, vnr_pred_state->output_vnr_pred);
     configuration_push_vnr_value((int)(float_s32_to_float(vnr_pred_state->output_vnr_pred) * 100));
 
     float_s32_t agc_vnr_threshold = f32_to_float_s32(VNR_AGC_THRESHOLD);
@@ -99,13 +155,14 @@ static void stage_vnr_and_ic(frame_data_t *frame_data)
     /* Intentionally ignoring comms ch from here on out */
     memcpy(frame_data->samples[0], ic_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
     memcpy(frame_data->aec_reference_audio_samples[0], ic_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));   // Store the interference cancelled audio in the first reference channel
-#endif
 }
 
 static void stage_ns(frame_data_t *frame_data)
 {
-#if appconfAUDIO_PIPELINE_SKIP_NS
-#else
+    if (frame_data->ctrl.bypass_mask & AP_BYPASS_NS) {
+        return;
+    }
+
     int32_t DWORD_ALIGNED ns_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     configASSERT(NS_FRAME_ADVANCE == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
     ns_process_frame(
@@ -114,13 +171,14 @@ static void stage_ns(frame_data_t *frame_data)
                 frame_data->samples[0]);
     memcpy(frame_data->samples[0], ns_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
     memcpy(frame_data->aec_reference_audio_samples[1], ns_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));   // Store NS audio in the second reference channel
-#endif
 }
 
 static void stage_agc(frame_data_t *frame_data)
 {
-#if appconfAUDIO_PIPELINE_SKIP_AGC
-#else
+    if (frame_data->ctrl.bypass_mask & AP_BYPASS_AGC) {
+        return;
+    }
+
     int32_t DWORD_ALIGNED agc_output[appconfAUDIO_PIPELINE_FRAME_ADVANCE];
     configASSERT(AGC_FRAME_ADVANCE == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
@@ -133,8 +191,8 @@ static void stage_agc(frame_data_t *frame_data)
             agc_output,
             frame_data->samples[0],
             &agc_stage_state.md);
+    pipeline_telemetry_set_agc_gain(&frame_data->telemetry, agc_stage_state.state.config.gain);
     memcpy(frame_data->samples, agc_output, appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
-#endif
 }
 
 static void initialize_pipeline_stages(void)
@@ -146,15 +204,18 @@ static void initialize_pipeline_stages(void)
     agc_init(&agc_stage_state.state, &AGC_PROFILE_ASR);
     agc_stage_state.md.aec_ref_power = AGC_META_DATA_NO_AEC;
     agc_stage_state.md.aec_corr_factor = AGC_META_DATA_NO_AEC;
+
+    audio_pipeline_ctrl_set_aec_profile(&aec_profile);
+    audio_pipeline_ctrl_set_mic_delay_limit(DELAY_BUF_MAX_DELAY_SAMPLES);
 }
 
 void audio_pipeline_init(
     void *input_app_data,
     void *output_app_data)
 {
-    const int stage_count = 3;
+    const int stage_count = AUDIO_PIPELINE_STAGE_COUNT;
 
-    const pipeline_stage_t stages[] = {
+    pipeline_stage_t stages[] = {
         (pipeline_stage_t)stage_vnr_and_ic,
         (pipeline_stage_t)stage_ns,
         (pipeline_stage_t)stage_agc,
@@ -166,7 +227,15 @@ void audio_pipeline_init(
         configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_agc) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i),
     };
 
+    const char * const stage_names[] = {
+        "stage_vnr_and_ic",
+        "stage_ns",
+        "stage_agc",
+    };
+
+    frame_pool_init(&frame_pool, "tile0", frame_pool_storage, sizeof(frame_data_t), FRAME_POOL_DEPTH(stage_count));
     initialize_pipeline_stages();
+    stage_profiler_wrap(stages, stage_names, stage_count);
 
     generic_pipeline_init((pipeline_input_t)audio_pipeline_input_i,
                         (pipeline_output_t)audio_pipeline_output_i,
@@ -4,6 +4,7 @@
 /* STD headers */
 #include <string.h>
 #include <stdint.h>
+#include <stddef.h>
 #include <xcore/hwtimer.h>
 
 /* FreeRTOS headers */
@@ -11,7 +12,6 @@
 #include "task.h"
 #include "timers.h"
 #include "queue.h"
-#include "stream_buffer.h"
 
 /* Library headers */
 #include "generic_pipeline.h"
@@ -20,99 +20,135 @@
 #include "app_conf.h"
 #include "audio_pipeline.h"
 #include "audio_pipeline_dsp.h"
+#include "stage_profiler.h"
+#include "frame_pool.h"
+#include "audio_pipeline_wire.h"
+#include "audio_pipeline_ctrl.h"
 
 #if appconfAUDIO_PIPELINE_FRAME_ADVANCE != 240
 #error This pipeline is only configured for 240 frame advance
 #endif
 
+#define AUDIO_PIPELINE_STAGE_COUNT (2)
+
 #if ON_TILE(1)
-#if appconfINPUT_SAMPLES_MIC_DELAY_MS != 0
 static stage_delay_ctx_t DWORD_ALIGNED delay_buf_state = {};
-#endif
 static aec_ctx_t DWORD_ALIGNED aec_state = {};
+static int profiler_first_slot;
+static frame_data_t DWORD_ALIGNED frame_pool_storage[FRAME_POOL_DEPTH(AUDIO_PIPELINE_STAGE_COUNT)];
+static frame_pool_t frame_pool;
 
 
 static void *audio_pipeline_input_i(void *input_app_data)
 {
     frame_data_t *frame_data;
 
-    frame_data = pvPortMalloc(sizeof(frame_data_t));
-    memset(frame_data, 0x00, sizeof(frame_data_t));
+    frame_data = frame_pool_acquire(&frame_pool);
+
+    /* Every sample is overwritten below, so only the metadata after them needs clearing */
+    memset(&frame_data->vnr_pred_flag, 0x00, sizeof(frame_data_t) - offsetof(frame_data_t, vnr_pred_flag));
 
     audio_pipeline_input(input_app_data,
                        (int32_t **)frame_data->aec_reference_audio_samples,
                        4,
                        appconfAUDIO_PIPELINE_FRAME_ADVANCE);
 
-    frame_data->vnr_pred_flag = 0;
+    audio_pipeline_input_status(input_app_data, &frame_data->input_status);
 
     memcpy(frame_data->samples, frame_data->mic_samples_passthrough, sizeof(frame_data->samples));
 
+    /* The settings are latched per frame so both tiles see the same ones */
+    audio_pipeline_ctrl_poll(intertile_ctx);
+    audio_pipeline_ctrl_get(&frame_data->ctrl);
+
     return frame_data;
 }
 
 static int audio_pipeline_output_i(frame_data_t *frame_data,
                                    void *output_app_data)
 {
-    rtos_intertile_tx(intertile_ctx,
-                      appconfAUDIOPIPELINE_PORT,
-                      frame_data,
-                      sizeof(frame_data_t));
-    return AUDIO_PIPELINE_FREE_FRAME;
+    stage_profiler_snapshot(&frame_data->stage_profile, profiler_first_slot, AUDIO_PIPELINE_STAGE_COUNT);
+
+    /* Only the channels tile 0 asked for are sent */
+    ap_wire_send(intertile_ctx,
+                 appconfAUDIOPIPELINE_PORT,
+                 frame_data->ctrl.wire_format,
+                 frame_data->ctrl.channel_mask,
+                 frame_data->ctrl.seq,
+                 AP_FRAME_METADATA(frame_data),
+                 AP_FRAME_METADATA_BYTES,
+                 &frame_data->samples[0][0],
+                 AP_FRAME_CHANNELS,
+                 appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+    frame_pool_release(&frame_pool, frame_data);
+    return AUDIO_PIPELINE_DONT_FREE_FRAME;
 }
 
 static void stage_delay(frame_data_t *frame_data)
 {
-#if appconfAUDIO_PIPELINE_SKIP_STATIC_DELAY
-#else
-#if (appconfINPUT_SAMPLES_MIC_DELAY_MS > 0) /* Delay mics */
-    size_t bytes_sent = xStreamBufferSend(
-                                delay_buf_state.delay_buf,
-                                &frame_data->samples,
-                                AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES,
-                                0);
-
-    configASSERT(bytes_sent == AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES);
-
-    if (xStreamBufferBytesAvailable(delay_buf_state.delay_buf) > AP_INPUT_SAMPLES_MIC_DELAY_BUF_SIZE_BYTES) {
-        size_t bytes_rx = xStreamBufferReceive(
-                                    delay_buf_state.delay_buf,
-                                    &frame_data->samples,
-                                    AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES,
-                                    0);
-
-        configASSERT(bytes_rx == AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES);
+    delay_buf_state_t *delay_state = &delay_buf_state.delay_state;
+
+    if (frame_data->ctrl.bypass_mask & AP_BYPASS_STATIC_DELAY) {
+        delay_buf_state.bypassed = 1;
+        return;
     }
-#elif (appconfINPUT_SAMPLES_MIC_DELAY_MS < 0) /* Delay Ref*/
-    size_t bytes_sent = xStreamBufferSend(
-                                delay_buf_state.delay_buf,
-                                &frame_data->aec_reference_audio_samples,
-                                AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES,
-                                0);
-
-    configASSERT(bytes_sent == AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES);
-
-    if (xStreamBufferBytesAvailable(delay_buf_state.delay_buf) > AP_INPUT_SAMPLES_MIC_DELAY_BUF_SIZE_BYTES) {
-        size_t bytes_rx = xStreamBufferReceive(
-                                    delay_buf_state.delay_buf,
-                                    &frame_data->aec_reference_audio_samples,
-                                    AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES,
-                                    0);
-
-        configASSERT(bytes_rx == AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES);
+
+    if (delay_buf_state.bypassed || frame_data->ctrl.mic_delay_samples != delay_state->delay_samples) {
+        /* Drop the audio buffered before a bypass or delay change rather than replay it */
+        update_delay_samples(delay_state, frame_data->ctrl.mic_delay_samples);
+        for (int ch = 0; ch < MAX_DELAY_BUF_CHANNELS; ch++) {
+            reset_partial_delay_buffer(delay_state, ch);
+        }
+        delay_buf_state.bypassed = 0;
+    }
+
+    if (delay_state->delay_samples == 0) {
+        return;
+    }
+
+    /* A positive delay delays the mics, a negative one the reference */
+    int32_t (*delayed)[appconfAUDIO_PIPELINE_FRAME_ADVANCE] = (delay_state->delay_samples > 0) ?
+                                                              frame_data->samples :
+                                                              frame_data->aec_reference_audio_samples;
+
+    for (int ch = 0; ch < MAX_DELAY_BUF_CHANNELS; ch++) {
+        get_delayed_samples(delay_state, &delayed[ch][0], ch, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
     }
-#else /* Delay None */
-#endif
-#endif /* appconfAUDIO_PIPELINE_SKIP_DELAY */
+}
+
+static void aec_configure(uint8_t main_phases, uint8_t shadow_phases)
+{
+    aec_init(&aec_state.aec_main_state,
+             &aec_state.aec_shadow_state,
+             &aec_state.aec_shared_state,
+             &aec_state.aec_main_memory_pool[0],
+             &aec_state.aec_shadow_memory_pool[0],
+             AEC_MAX_Y_CHANNELS,
+             AEC_MAX_X_CHANNELS,
+             main_phases,
+             shadow_phases);
 }
 
 static void stage_aec(frame_data_t *frame_data)
 {
-#if appconfAUDIO_PIPELINE_SKIP_AEC
-#else
+    if (frame_data->ctrl.bypass_mask & AP_BYPASS_AEC) {
+        return;
+    }
+
+    /* A new filter length restarts the AEC. Tile 0 has checked that it fits */
+    if (frame_data->ctrl.aec_main_phases != 0 &&
+        (frame_data->ctrl.aec_main_phases != aec_state.aec_main_state.num_phases ||
+         frame_data->ctrl.aec_shadow_phases != aec_state.aec_shadow_state.num_phases)) {
+        aec_configure(frame_data->ctrl.aec_main_phases, frame_data->ctrl.aec_shadow_phases);
+    }
+
     int32_t DWORD_ALIGNED stage1_output[AEC_MAX_Y_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
 
+#if (NUM_AEC_THREADS > 1)
+    aec_process_frame_2threads(
+#else
     aec_process_frame_1thread(
+#endif
             &aec_state.aec_main_state,
             &aec_state.aec_shadow_state,
             stage1_output,
@@ -125,35 +161,26 @@ static void stage_aec(frame_data_t *frame_data)
                                     aec_state.aec_main_state.shared_state->num_x_channels);
     frame_data->aec_corr_factor = aec_calc_corr_factor(&aec_state.aec_main_state, 0);
     memcpy(frame_data->samples, stage1_output, AEC_MAX_Y_CHANNELS * appconfAUDIO_PIPELINE_FRAME_ADVANCE * sizeof(int32_t));
-#endif
 }
 
 static void initialize_pipeline_stages(void)
 {
-#if (appconfINPUT_SAMPLES_MIC_DELAY_MS != 0)
-    configASSERT(AP_INPUT_SAMPLES_MIC_DELAY_BUF_SIZE_BYTES > 0);
-    delay_buf_state.delay_buf = xStreamBufferCreate((size_t)AP_INPUT_SAMPLES_MIC_DELAY_BUF_SIZE_BYTES + AP_INPUT_SAMPLES_MIC_DELAY_CUR_FRAME_BYTES, 0);
-    configASSERT(delay_buf_state.delay_buf);
+    delay_buffer_init(&delay_buf_state.delay_state, AP_MIC_DELAY_DEFAULT);
+
+#if (NUM_AEC_THREADS > 1)
+    aec_process_frame_2threads_init(appconfAUDIO_PIPELINE_TASK_PRIORITY);
 #endif
 
-    aec_init(&aec_state.aec_main_state,
-             &aec_state.aec_shadow_state,
-             &aec_state.aec_shared_state,
-             &aec_state.aec_main_memory_pool[0],
-             &aec_state.aec_shadow_memory_pool[0],
-             AEC_MAX_Y_CHANNELS,
-             AEC_MAX_X_CHANNELS,
-             AEC_MAIN_FILTER_PHASES,
-             AEC_SHADOW_FILTER_PHASES);
+    aec_configure(AEC_MAIN_FILTER_PHASES, AEC_SHADOW_FILTER_PHASES);
 }
 
 void audio_pipeline_init(
     void *input_app_data,
     void *output_app_data)
 {
-    const int stage_count = 2;
+    const int stage_count = AUDIO_PIPELINE_STAGE_COUNT;
 
-    const pipeline_stage_t stages[] = {
+    pipeline_stage_t stages[] = {
         (pipeline_stage_t)stage_delay,
         (pipeline_stage_t)stage_aec,
     };
@@ -163,7 +190,14 @@ void audio_pipeline_init(
         configMINIMAL_STACK_SIZE + RTOS_THREAD_STACK_SIZE(stage_aec) + RTOS_THREAD_STACK_SIZE(audio_pipeline_output_i),
     };
 
+    const char * const stage_names[] = {
+        "stage_delay",
+        "stage_aec",
+    };
+
+    frame_pool_init(&frame_pool, "tile1", frame_pool_storage, sizeof(frame_data_t), FRAME_POOL_DEPTH(stage_count));
     initialize_pipeline_stages();
+    profiler_first_slot = stage_profiler_wrap(stages, stage_names, stage_count);
 
     generic_pipeline_init((pipeline_input_t)audio_pipeline_input_i,
                         (pipeline_output_t)audio_pipeline_output_i,
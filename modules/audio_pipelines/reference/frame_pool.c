@@ -0,0 +1,105 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Library headers */
+#include "rtos_printf.h"
+
+/* App headers */
+#include "frame_pool.h"
+
+#if (FRAME_POOL_MAX_FRAMES & (FRAME_POOL_MAX_FRAMES - 1)) != 0
+#error FRAME_POOL_MAX_FRAMES must be a power of two
+#endif
+
+#define FRAME_POOL_INDEX(n) ((n) & (FRAME_POOL_MAX_FRAMES - 1))
+
+/* Orders the ring slot access against the index update */
+#define FRAME_POOL_BARRIER() asm volatile("" ::: "memory")
+
+static frame_pool_t *pools[FRAME_POOL_MAX_POOLS];
+static int pool_count;
+
+void frame_pool_init(frame_pool_t *pool,
+                     const char *name,
+                     void *storage,
+                     size_t frame_size,
+                     uint32_t capacity)
+{
+    configASSERT(capacity > 0 && capacity <= FRAME_POOL_MAX_FRAMES);
+    configASSERT(pool_count < FRAME_POOL_MAX_POOLS);
+
+    memset(pool, 0x00, sizeof(frame_pool_t));
+    pool->name = name;
+    pool->storage = storage;
+    pool->frame_size = frame_size;
+    pool->capacity = capacity;
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        pool->free_list[i] = i;
+    }
+    pool->tail = capacity;
+
+    pools[pool_count++] = pool;
+}
+
+void *frame_pool_acquire(frame_pool_t *pool)
+{
+    const uint32_t head = pool->head;
+
+    if (head == pool->tail) {
+        pool->starved++;
+        while (head == pool->tail) {
+            vTaskDelay(1);
+        }
+    }
+
+    FRAME_POOL_BARRIER();
+    const uint32_t index = pool->free_list[FRAME_POOL_INDEX(head)];
+    FRAME_POOL_BARRIER();
+    pool->head = head + 1;
+
+    const uint32_t in_use = pool->capacity - (pool->tail - (head + 1));
+    if (in_use > pool->high_water) {
+        pool->high_water = in_use;
+    }
+
+    return pool->storage + index * pool->frame_size;
+}
+
+void frame_pool_release(frame_pool_t *pool, void *frame)
+{
+    const uint32_t tail = pool->tail;
+    const size_t offset = (uint8_t *) frame - pool->storage;
+    const uint32_t index = offset / pool->frame_size;
+
+    configASSERT(offset % pool->frame_size == 0 && index < pool->capacity);
+    configASSERT(tail - pool->head < pool->capacity);
+
+    pool->free_list[FRAME_POOL_INDEX(tail)] = index;
+    FRAME_POOL_BARRIER();
+    pool->tail = tail + 1;
+}
+
+uint32_t frame_pool_high_water(const frame_pool_t *pool)
+{
+    return pool->high_water;
+}
+
+void frame_pool_print_stats(void)
+{
+    for (int i = 0; i < pool_count; i++) {
+        rtos_printf("\tFrame pool %s: high water %u of %u frames, starved %u times\n",
+                    pools[i]->name,
+                    pools[i]->high_water,
+                    pools[i]->capacity,
+                    pools[i]->starved);
+    }
+}
@@ -0,0 +1,68 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef FRAME_POOL_H_
+#define FRAME_POOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Maximum frames in one pool. Must be a power of two */
+#define FRAME_POOL_MAX_FRAMES   (16)
+
+/* Maximum pools on one tile, for frame_pool_print_stats() */
+#define FRAME_POOL_MAX_POOLS    (2)
+
+/**
+ * Pool depth for a generic_pipeline with stage_count stages. Each stage
+ * task holds at most one frame and each queue between stages one more,
+ * with one spare for the input.
+ */
+#define FRAME_POOL_DEPTH(stage_count)   (2 * (stage_count) + 1)
+
+/**
+ * Fixed capacity pool of frames in caller provided static storage.
+ *
+ * The free list is a single producer, single consumer ring of frame
+ * indices, so it is lock free provided frames are acquired by one task
+ * (the pipeline input) and released by one task (the pipeline output).
+ */
+typedef struct {
+    const char *name;
+    uint8_t *storage;
+    size_t frame_size;
+    uint32_t capacity;
+    uint32_t free_list[FRAME_POOL_MAX_FRAMES];
+    volatile uint32_t head;     /* Written by the acquiring task only */
+    volatile uint32_t tail;     /* Written by the releasing task only */
+    volatile uint32_t high_water;
+    volatile uint32_t starved;
+} frame_pool_t;
+
+/**
+ * Initialises pool over storage, which must hold capacity frames of
+ * frame_size bytes each.
+ */
+void frame_pool_init(frame_pool_t *pool,
+                     const char *name,
+                     void *storage,
+                     size_t frame_size,
+                     uint32_t capacity);
+
+/**
+ * Takes a frame from the pool. If the pool is empty the caller is held
+ * until the pipeline output releases one. The frame contents are whatever
+ * its previous user left in it.
+ */
+void *frame_pool_acquire(frame_pool_t *pool);
+
+/* Returns frame to the pool */
+void frame_pool_release(frame_pool_t *pool, void *frame);
+
+/* Most frames that have been in use at once */
+uint32_t frame_pool_high_water(const frame_pool_t *pool);
+
+/* Prints the capacity and high water mark of every pool on this tile */
+void frame_pool_print_stats(void);
+
+#endif /* FRAME_POOL_H_ */
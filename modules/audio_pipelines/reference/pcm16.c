@@ -0,0 +1,41 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stddef.h>
+
+/* Library headers */
+#include "xmath/xmath.h"
+
+/* App headers */
+#include "pcm16.h"
+
+/* Samples scaled per pass, on the caller's stack */
+#define PCM16_CHUNK     (40)
+
+void pcm16_from_s32(int16_t *dst, const int32_t *src, size_t n, int32_t gain)
+{
+    if (gain == PCM16_GAIN_UNITY) {
+        vect_s32_to_vect_s16(dst, src, n, 16);
+        return;
+    }
+
+    /*
+     * The gain is applied as src * gain >> 30, then the result is shifted
+     * down the last 2 bits to 16 bits. The first step only saturates where
+     * the second would have anyway.
+     */
+    int32_t scaled[PCM16_CHUNK];
+
+    while (n > 0) {
+        const size_t len = n < PCM16_CHUNK ? n : PCM16_CHUNK;
+
+        vect_s32_scale(scaled, src, len, gain, 0, 0);
+        vect_s32_to_vect_s16(dst, scaled, len, 16 + PCM16_GAIN_Q - 30);
+
+        dst += len;
+        src += len;
+        n -= len;
+    }
+}
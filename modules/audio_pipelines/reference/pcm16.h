@@ -0,0 +1,31 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef PCM16_H_
+#define PCM16_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Conversion of pipeline audio to 16 bit PCM. Samples are scaled by a
+ * fixed point gain, rounded to nearest and saturated, so a hot signal
+ * clips rather than wraps. The S16 intertile wire format is the only user
+ * in this tree; nothing else in ffva consumes 16 bit samples.
+ */
+
+/* Gain is Q16.16. Unity gain keeps the top 16 bits of each sample */
+#define PCM16_GAIN_Q        (16)
+#define PCM16_GAIN_UNITY    (1 << PCM16_GAIN_Q)
+
+/**
+ * Converts n samples of one channel. Pipeline frames are channel major, so
+ * src is a whole channel of the frame.
+ *
+ * \param dst   n int16_t, word aligned
+ * \param src   n int32_t, word aligned
+ * \param gain  Gain in Q16.16, greater than 0
+ */
+void pcm16_from_s32(int16_t *dst, const int32_t *src, size_t n, int32_t gain);
+
+#endif /* PCM16_H_ */
@@ -0,0 +1,105 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+/* App headers */
+#include "app_conf.h"
+#include "pipeline_telemetry.h"
+
+#define TELEMETRY_BARRIER() asm volatile("" ::: "memory")
+
+static pipeline_telemetry_t ring[PIPELINE_TELEMETRY_FRAMES];
+
+/* Records published since start up. Record n is in ring[n % PIPELINE_TELEMETRY_FRAMES] */
+static volatile uint32_t published;
+
+static uint8_t to_u8_unit(float x)
+{
+    if (x <= 0.0f) return 0;
+    if (x >= 1.0f) return UINT8_MAX;
+    return (uint8_t) (x * UINT8_MAX + 0.5f);
+}
+
+void pipeline_telemetry_clear(pipeline_telemetry_t *record)
+{
+    memset(record, 0, sizeof(*record));
+}
+
+void pipeline_telemetry_set_vnr(pipeline_telemetry_t *record, float_s32_t vnr_in, float_s32_t vnr_out)
+{
+    record->vnr_in = to_u8_unit(float_s32_to_float(vnr_in));
+    record->vnr_out = to_u8_unit(float_s32_to_float(vnr_out));
+}
+
+void pipeline_telemetry_set_agc_gain(pipeline_telemetry_t *record, float_s32_t gain)
+{
+    const float g = float_s32_to_float(gain);
+    float cdb = (g > 0.0f) ? 2000.0f * log10f(g) : INT16_MIN;
+
+    if (cdb > INT16_MAX) cdb = INT16_MAX;
+    if (cdb < INT16_MIN) cdb = INT16_MIN;
+    record->agc_gain_cdb = (int16_t) cdb;
+}
+
+void pipeline_telemetry_publish(pipeline_telemetry_t *record,
+                                float_s32_t max_ref_energy,
+                                float_s32_t aec_corr_factor,
+                                int32_t ref_active_flag,
+                                int32_t vnr_pred_flag)
+{
+    const float full_scale = appconfAUDIO_PIPELINE_FRAME_ADVANCE;
+    const float energy = float_s32_to_float(max_ref_energy);
+    float db = (energy > 0.0f) ? 10.0f * log10f(energy / full_scale) : INT8_MIN;
+
+    if (db > INT8_MAX) db = INT8_MAX;
+    if (db < INT8_MIN) db = INT8_MIN;
+    record->ref_energy_db = (int8_t) db;
+    record->aec_corr = to_u8_unit(float_s32_to_float(aec_corr_factor));
+    record->flags |= (ref_active_flag ? PIPELINE_TELEMETRY_REF_ACTIVE : 0) |
+                     (vnr_pred_flag ? PIPELINE_TELEMETRY_VNR_FLAG : 0);
+
+    /* The slot of the oldest record is rewritten in place, readers check for this after copying */
+    ring[published % PIPELINE_TELEMETRY_FRAMES] = *record;
+    TELEMETRY_BARRIER();
+    published++;
+}
+
+uint32_t pipeline_telemetry_next_seq(void)
+{
+    return published;
+}
+
+size_t pipeline_telemetry_read(uint32_t seq,
+                               pipeline_telemetry_t *records,
+                               size_t max,
+                               uint32_t *first_seq)
+{
+    for (;;) {
+        const uint32_t head = published;
+        size_t count = 0;
+
+        /* The slot of record head - PIPELINE_TELEMETRY_FRAMES is the one being rewritten next */
+        if ((int32_t) (head - seq) > (int32_t) (PIPELINE_TELEMETRY_FRAMES - 1)) {
+            seq = head - (PIPELINE_TELEMETRY_FRAMES - 1);
+        } else if ((int32_t) (head - seq) < 0) {
+            /* Not published yet, which would never pass the check below */
+            seq = head;
+        }
+
+        while (count < max && (int32_t) (head - (seq + count)) > 0) {
+            records[count] = ring[(seq + count) % PIPELINE_TELEMETRY_FRAMES];
+            count++;
+        }
+        TELEMETRY_BARRIER();
+
+        /* Keep the copy only if the writer did not start on its first slot meanwhile */
+        if (published - seq < PIPELINE_TELEMETRY_FRAMES) {
+            *first_seq = seq;
+            return count;
+        }
+    }
+}
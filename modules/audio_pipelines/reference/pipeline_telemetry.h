@@ -0,0 +1,79 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef PIPELINE_TELEMETRY_H_
+#define PIPELINE_TELEMETRY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "xmath/xmath.h"
+
+/*
+ * History of the per frame state of the tile 0 pipeline, for the host to
+ * read in bulk. Each frame carries a record that the stages fill in, which
+ * the pipeline output publishes. Records are numbered from 0 at start up,
+ * so a reader can fetch only those it has not seen.
+ */
+
+/* Records kept, 3.84 s of 15 ms frames. Must be a power of two */
+#define PIPELINE_TELEMETRY_FRAMES       (256)
+
+/* Flags bits */
+#define PIPELINE_TELEMETRY_REF_ACTIVE   (1 << 0)    /* ref_active_flag, pipelines that set it */
+#define PIPELINE_TELEMETRY_VNR_FLAG     (1 << 1)    /* vnr_pred_flag, output VNR over the AGC threshold */
+
+typedef struct {
+    uint8_t vnr_in;         /* IC input VNR estimate, 0-255 for 0-1 */
+    uint8_t vnr_out;        /* IC output VNR estimate, 0-255 for 0-1 */
+    int8_t ref_energy_db;   /* Largest reference channel energy, dB relative to a full scale frame */
+    uint8_t aec_corr;       /* AEC correlation factor, 0-255 for 0-1 */
+    int16_t agc_gain_cdb;   /* AGC adaptive gain, in hundredths of a dB */
+    uint8_t flags;          /* PIPELINE_TELEMETRY_* */
+    uint8_t reserved;
+} pipeline_telemetry_t;
+
+/**
+ * Clears a frame's record. Called by the pipeline input as each frame is
+ * received, so stages that are bypassed leave their fields at 0.
+ */
+void pipeline_telemetry_clear(pipeline_telemetry_t *record);
+
+/* Sets the VNR estimates, from the IC stage */
+void pipeline_telemetry_set_vnr(pipeline_telemetry_t *record, float_s32_t vnr_in, float_s32_t vnr_out);
+
+/* Sets the AGC gain, from the AGC stage */
+void pipeline_telemetry_set_agc_gain(pipeline_telemetry_t *record, float_s32_t gain);
+
+/**
+ * Sets the fields carried from tile 1 and adds the record to the history.
+ * Called by the pipeline output once per frame. There must be only one
+ * caller.
+ *
+ * \param max_ref_energy    energy of a frame of the loudest reference
+ *                          channel, where full scale samples are +-1
+ */
+void pipeline_telemetry_publish(pipeline_telemetry_t *record,
+                                float_s32_t max_ref_energy,
+                                float_s32_t aec_corr_factor,
+                                int32_t ref_active_flag,
+                                int32_t vnr_pred_flag);
+
+/* Returns the number of the next record to be published */
+uint32_t pipeline_telemetry_next_seq(void);
+
+/**
+ * Copies up to max records, oldest first, starting at record seq. If seq
+ * has been overwritten, the copy starts at the oldest record kept, and if
+ * it is past the next record to be published, at that record. Safe to
+ * call from any task on the tile while records are published.
+ *
+ * \param first_seq     set to the number of the first record copied
+ *
+ * \returns the records copied.
+ */
+size_t pipeline_telemetry_read(uint32_t seq,
+                               pipeline_telemetry_t *records,
+                               size_t max,
+                               uint32_t *first_seq);
+
+#endif /* PIPELINE_TELEMETRY_H_ */
@@ -0,0 +1,214 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <string.h>
+#include <stdint.h>
+#include <xcore/hwtimer.h>
+
+/* FreeRTOS headers */
+#include "FreeRTOS.h"
+
+/* Library headers */
+#include "generic_pipeline.h"
+
+/* App headers */
+#include "stage_profiler.h"
+
+#if (STAGE_PROFILER_WINDOW & (STAGE_PROFILER_WINDOW - 1)) != 0
+#error STAGE_PROFILER_WINDOW must be a power of two
+#endif
+
+/* The p99 figure is the k-th largest sample in the window */
+#define STAGE_PROFILER_P99_MAX_RANK (STAGE_PROFILER_WINDOW / 100 + 1)
+
+/*
+ * Each slot is written only by the task running its stage, and read by
+ * whoever reports. Every field is a single word, so readers need no lock.
+ * A report may straddle a frame boundary, which is harmless for stats.
+ */
+typedef struct {
+    pipeline_stage_t stage;
+    const char *name;
+    volatile uint32_t frames;
+    volatile uint32_t min;
+    volatile uint32_t max;
+    volatile uint32_t sum;      /* Of the ring, kept as samples enter and leave it */
+    uint32_t p99;               /* Last p99 worked out by stage_profiler_snapshot() */
+    uint32_t ring[STAGE_PROFILER_WINDOW];
+    uint32_t hist[STAGE_PROFILER_HIST_BINS];
+} stage_profiler_slot_t;
+
+static stage_profiler_slot_t slots[STAGE_PROFILER_MAX_STAGES];
+static int slot_count;
+static uint32_t snapshot_count;
+static stage_profiler_snapshot_t remote;
+
+static void stage_profiler_run(int slot, void *frame_data)
+{
+    stage_profiler_slot_t *s = &slots[slot];
+    const uint32_t start = get_reference_time();
+
+    s->stage(frame_data);
+
+    const uint32_t ticks = get_reference_time() - start;
+    const uint32_t n = s->frames;
+    uint32_t *oldest = &s->ring[n & (STAGE_PROFILER_WINDOW - 1)];
+
+    s->sum += ticks - *oldest;
+    *oldest = ticks;
+    if (n == 0 || ticks < s->min) {
+        s->min = ticks;
+    }
+    if (ticks > s->max) {
+        s->max = ticks;
+    }
+    int bin = ticks == 0 ? 0 : 32 - __builtin_clz(ticks);
+    if (bin >= STAGE_PROFILER_HIST_BINS) {
+        bin = STAGE_PROFILER_HIST_BINS - 1;
+    }
+    s->hist[bin]++;
+    s->frames = n + 1;
+}
+
+/*
+ * generic_pipeline stages take only the frame, so each slot gets its own
+ * trampoline to find its way back to the stage it times.
+ */
+#define STAGE_PROFILER_TRAMPOLINE(n) \
+    static void stage_profiler_trampoline_##n(void *frame_data) { stage_profiler_run(n, frame_data); }
+
+STAGE_PROFILER_TRAMPOLINE(0)
+STAGE_PROFILER_TRAMPOLINE(1)
+STAGE_PROFILER_TRAMPOLINE(2)
+STAGE_PROFILER_TRAMPOLINE(3)
+STAGE_PROFILER_TRAMPOLINE(4)
+STAGE_PROFILER_TRAMPOLINE(5)
+STAGE_PROFILER_TRAMPOLINE(6)
+STAGE_PROFILER_TRAMPOLINE(7)
+
+static const pipeline_stage_t trampolines[STAGE_PROFILER_MAX_STAGES] = {
+    stage_profiler_trampoline_0,
+    stage_profiler_trampoline_1,
+    stage_profiler_trampoline_2,
+    stage_profiler_trampoline_3,
+    stage_profiler_trampoline_4,
+    stage_profiler_trampoline_5,
+    stage_profiler_trampoline_6,
+    stage_profiler_trampoline_7,
+};
+
+int stage_profiler_wrap(pipeline_stage_t *stages,
+                        const char * const *names,
+                        int stage_count)
+{
+    const int first_slot = slot_count;
+
+    configASSERT(slot_count + stage_count <= STAGE_PROFILER_MAX_STAGES);
+
+    for (int i = 0; i < stage_count; i++) {
+        stage_profiler_slot_t *s = &slots[slot_count];
+        s->stage = stages[i];
+        s->name = names[i];
+        stages[i] = trampolines[slot_count];
+        slot_count++;
+    }
+
+    return first_slot;
+}
+
+int stage_profiler_stage_count(void)
+{
+    return slot_count;
+}
+
+const char *stage_profiler_stage_name(int slot)
+{
+    configASSERT(slot < slot_count);
+    return slots[slot].name;
+}
+
+static uint32_t stage_profiler_window(const stage_profiler_slot_t *s)
+{
+    const uint32_t frames = s->frames;
+    return frames < STAGE_PROFILER_WINDOW ? frames : STAGE_PROFILER_WINDOW;
+}
+
+static uint32_t stage_profiler_p99(const stage_profiler_slot_t *s)
+{
+    uint32_t top[STAGE_PROFILER_P99_MAX_RANK] = {0};
+    const uint32_t n = stage_profiler_window(s);
+    const uint32_t rank = n / 100 + 1;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t t = s->ring[i];
+
+        /* Keep the `rank` largest samples, in descending order */
+        for (uint32_t j = 0; j < rank; j++) {
+            if (t > top[j]) {
+                uint32_t tmp = top[j];
+                top[j] = t;
+                t = tmp;
+            }
+        }
+    }
+
+    return top[rank - 1];
+}
+
+/* Everything but p99, which is left to the caller */
+static void stage_profiler_summary(const stage_profiler_slot_t *s, stage_profiler_stats_t *stats)
+{
+    const uint32_t n = stage_profiler_window(s);
+
+    stats->frames = s->frames;
+    stats->min = s->min;
+    stats->max = s->max;
+    stats->avg = n ? s->sum / n : 0;
+}
+
+void stage_profiler_get_stats(int slot, stage_profiler_stats_t *stats)
+{
+    configASSERT(slot < slot_count);
+    const stage_profiler_slot_t *s = &slots[slot];
+
+    stage_profiler_summary(s, stats);
+    stats->p99 = stage_profiler_p99(s);
+}
+
+const uint32_t *stage_profiler_get_histogram(int slot)
+{
+    configASSERT(slot < slot_count);
+    return slots[slot].hist;
+}
+
+void stage_profiler_snapshot(stage_profiler_snapshot_t *snapshot, int first_slot, int stage_count)
+{
+    uint32_t count = stage_count > STAGE_PROFILER_MAX_REMOTE_STAGES ? STAGE_PROFILER_MAX_REMOTE_STAGES : stage_count;
+
+    configASSERT(first_slot + stage_count <= slot_count);
+
+    /* Sorting out p99 is the costly part, so only one stage is redone at a time */
+    if (count > 0 && (snapshot_count % STAGE_PROFILER_P99_REFRESH) == 0) {
+        stage_profiler_slot_t *s = &slots[first_slot + (snapshot_count / STAGE_PROFILER_P99_REFRESH) % count];
+        s->p99 = stage_profiler_p99(s);
+    }
+    snapshot_count++;
+
+    snapshot->stage_count = count;
+    for (uint32_t i = 0; i < count; i++) {
+        const stage_profiler_slot_t *s = &slots[first_slot + i];
+        stage_profiler_summary(s, &snapshot->stats[i]);
+        snapshot->stats[i].p99 = s->p99;
+    }
+}
+
+void stage_profiler_set_remote(const stage_profiler_snapshot_t *snapshot)
+{
+    memcpy(&remote, snapshot, sizeof(remote));
+}
+
+void stage_profiler_get_remote(stage_profiler_snapshot_t *snapshot)
+{
+    memcpy(snapshot, &remote, sizeof(remote));
+}
@@ -0,0 +1,88 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef STAGE_PROFILER_H_
+#define STAGE_PROFILER_H_
+
+#include <stdint.h>
+#include "generic_pipeline.h"
+
+/* Maximum number of stages that can be profiled on one tile */
+#define STAGE_PROFILER_MAX_STAGES           (8)
+
+/* Number of most recent frames avg and p99 are taken over. Must be a power of two */
+#define STAGE_PROFILER_WINDOW               (128)
+
+/* log2 histogram, bin n counts the frames that took [2^(n-1), 2^n) ticks */
+#define STAGE_PROFILER_HIST_BINS            (32)
+
+/* Reference clock ticks per microsecond */
+#define STAGE_PROFILER_TICKS_PER_US         (100)
+
+/* Maximum number of stages from the other tile that are carried in a snapshot */
+#define STAGE_PROFILER_MAX_REMOTE_STAGES    (4)
+
+/* Snapshots between updates of the p99 of one stage in them */
+#define STAGE_PROFILER_P99_REFRESH          (16)
+
+/**
+ * Per stage timing, in reference clock ticks (10 ns).
+ * min and max cover every frame since start up, avg and p99 cover
+ * the last STAGE_PROFILER_WINDOW frames.
+ */
+typedef struct {
+    uint32_t frames;
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint32_t p99;
+} stage_profiler_stats_t;
+
+/**
+ * Stats for the stages of one tile, sized to travel with the frame
+ * to the other tile.
+ */
+typedef struct {
+    uint32_t stage_count;
+    stage_profiler_stats_t stats[STAGE_PROFILER_MAX_REMOTE_STAGES];
+} stage_profiler_snapshot_t;
+
+/**
+ * Replaces each entry of stages[] with a trampoline that times the
+ * original stage. Call on the array passed to generic_pipeline_init().
+ *
+ * \param stages        Stage functions, modified in place
+ * \param names         Name of each stage, used for reporting
+ * \param stage_count   Number of stages
+ *
+ * \returns the profiler slot of stages[0]. The remaining stages
+ *          occupy the following slots.
+ */
+int stage_profiler_wrap(pipeline_stage_t *stages,
+                        const char * const *names,
+                        int stage_count);
+
+/* Number of profiled stages on this tile */
+int stage_profiler_stage_count(void);
+
+const char *stage_profiler_stage_name(int slot);
+
+void stage_profiler_get_stats(int slot, stage_profiler_stats_t *stats);
+
+/* Returns the STAGE_PROFILER_HIST_BINS bins for slot */
+const uint32_t *stage_profiler_get_histogram(int slot);
+
+/**
+ * Fills snapshot with the stats of up to STAGE_PROFILER_MAX_REMOTE_STAGES
+ * of the stage_count local stages starting at first_slot. Cheap enough to
+ * call every frame: p99 is only worked out for one stage every
+ * STAGE_PROFILER_P99_REFRESH calls, the other stats are kept as frames run.
+ */
+void stage_profiler_snapshot(stage_profiler_snapshot_t *snapshot, int first_slot, int stage_count);
+
+/* Stores the most recent snapshot received from the other tile */
+void stage_profiler_set_remote(const stage_profiler_snapshot_t *snapshot);
+
+void stage_profiler_get_remote(stage_profiler_snapshot_t *snapshot);
+
+#endif /* STAGE_PROFILER_H_ */
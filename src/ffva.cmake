@@ -10,4 +10,8 @@ else()
 
     add_subdirectory(modules/xscope_fileio/xscope_fileio/host)
     install(TARGETS xscope_host_endpoint DESTINATION ${HOST_INSTALL_DIR})
+
+    if(ENABLE_FFVA_HOST_PIPELINES)
+        include(${CMAKE_CURRENT_LIST_DIR}/ffva/ffva_host.cmake)
+    endif()
 endif()
@@ -4,9 +4,15 @@
 #ifndef PLATFORM_INIT_H_
 #define PLATFORM_INIT_H_
 
+#include <stdint.h>
 #include <xcore/chanend.h>
 
 void platform_init(chanend_t other_tile_c);
 void platform_start(void);
 
+/* Sets the PORT_GPO pins in mask to those in value, leaving the others
+ * as they are. Called on tile 0 from any task, once the GPIO driver is
+ * started by platform_start() */
+void platform_gpo_set(uint32_t mask, uint32_t value);
+
 #endif /* PLATFORM_INIT_H_ */
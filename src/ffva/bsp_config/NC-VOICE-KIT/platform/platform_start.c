@@ -6,6 +6,7 @@
 
 /* FreeRTOS headers */
 #include "FreeRTOS.h"
+#include "task.h"
 
 /* Library headers */
 #include "fs_support.h"
@@ -13,6 +14,7 @@
 /* App headers */
 #include "platform_conf.h"
 #include "platform/driver_instances.h"
+#include "platform/platform_init.h"
 #include "usb_support.h"
 
 // #if appconfI2C_CTRL_ENABLED
@@ -22,9 +24,20 @@
 #include "configuration_common.h"
 // #endif
 
-extern void i2s_rate_conversion_enable(void);
-extern void i2s2_rate_conversion_enable(void);
 
+#if ON_TILE(0)
+/* Value driven on PORT_GPO. Reading the port would turn it around to an
+ * input and glitch its pins, so they are changed from this copy instead */
+static uint32_t gpo_value;
+
+void platform_gpo_set(uint32_t mask, uint32_t value)
+{
+    taskENTER_CRITICAL();
+    gpo_value = (gpo_value & ~mask) | (value & mask);
+    rtos_gpio_port_out(gpio_ctx_t0, rtos_gpio_port(PORT_GPO), gpo_value);
+    taskEXIT_CRITICAL();
+}
+#endif
 
 static void gpio_start(void)
 {
@@ -41,7 +54,7 @@ static void gpio_start(void)
     rtos_gpio_port_enable(gpio_ctx_t0, gpi_port);
     // rtos_gpio_port_enable(gpio_ctx_t0, i2c2_port);
 
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, 0);
+    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, gpo_value);
     rtos_gpio_port_in(gpio_ctx_t0, gpi_port);
     // rtos_gpio_port_in(gpio_ctx_t0, i2c2_port);
 #endif
@@ -62,20 +75,10 @@ static void flash_start(void)
 static void configuration_start(void)
 {
 #if ON_TILE(FLASH_TILE_NO)
-    configuration_init();
-    // read configuration
-    uint8_t *tmp_buf = rtos_osal_malloc( sizeof(uint8_t) * 16);
-    rtos_qspi_flash_read(
-        qspi_flash_ctx,
-        tmp_buf,
-        rtos_qspi_flash_size_get(qspi_flash_ctx) - 4096 * 2,
-        16);
-    for(uint8_t i = 0; i < 16; i++)
-    {
-        rtos_printf("0x%02X, ", tmp_buf[i]);
+    /* Indexes the configuration store, so later reads do not scan the flash */
+    if (configuration_init() != 0) {
+        rtos_printf("configuration store not available\n");
     }
-    rtos_printf("\n");
-    rtos_osal_free(tmp_buf);
 #endif
 }
 
@@ -97,9 +100,7 @@ static void audio_codec_start(void)
     int ret = 0;
 #if ON_TILE(I2C_TILE_NO)
     //  <!-- RST_DAC X0D32/8C6/output -->
-    rtos_gpio_port_id_t gpo_port = rtos_gpio_port(PORT_GPO);
-    uint32_t val = rtos_gpio_port_in(gpio_ctx_t0, gpo_port);
-    rtos_gpio_port_out(gpio_ctx_t0, gpo_port, val |= PIN_RST_DAC_OUT);
+    platform_gpo_set(PIN_RST_DAC_OUT, PIN_RST_DAC_OUT);
 
     rtos_intertile_tx(intertile_ctx, 0, &ret, sizeof(ret));
 #else
@@ -147,16 +148,13 @@ static void i2s_start(void)
     rtos_i2s_rpc_config(i2s1_ctx, appconfI2S_RPC_PORT, appconfI2S_RPC_PRIORITY);
 #endif
 #if ON_TILE(I2S_TILE_NO)
-    if (appconfI2S_AUDIO_SAMPLE_RATE == 3*appconfAUDIO_PIPELINE_SAMPLE_RATE) {
-        i2s_rate_conversion_enable();
-    }
-
+    /* The buffers hold I2S rate frames, the app converts them to and from the pipeline rate */
     rtos_i2s_start(
             i2s1_ctx,
             rtos_i2s_mclk_bclk_ratio(appconfAUDIO_CLOCK_FREQUENCY, appconfI2S_AUDIO_SAMPLE_RATE),
             I2S_MODE_I2S,
-            2.2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE,
-            1.2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * (appconfI2S_TDM_ENABLED ? 3 : 1),
+            2.2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * appconfI2S_SRC_FACTOR,
+            1.2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * appconfI2S_SRC_FACTOR,
             appconfI2S_INTERRUPT_CORE);
 #endif
 #endif
@@ -168,21 +166,15 @@ static void i2s2_start(void)
     // rtos_i2s_rpc_config(i2s2_ctx, appconfI2S2_RPC_PORT, appconfI2S2_RPC_PRIORITY);
 
 #if ON_TILE(I2S2_TILE_NO)
-
-    // if (appconfI2S_AUDIO_SAMPLE_RATE == 3*appconfAUDIO_PIPELINE_SAMPLE_RATE) {
-    //     i2s2_rate_conversion_enable();
-    // }
-
     rtos_i2s_start(
             i2s2_ctx,
             rtos_i2s_mclk_bclk_ratio(
                 appconfAUDIO_CLOCK_FREQUENCY,   //3.072M
                 // MIC_ARRAY_CONFIG_MCLK_FREQ,  // 24.576M
-                // appconfI2S_AUDIO_SAMPLE_RATE), // 48k
-                16000), // 16k
+                appconfI2S_AUDIO_SAMPLE_RATE),
             I2S_MODE_I2S,
-            2.2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE,
-            1.2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * (appconfI2S_TDM_ENABLED ? 3 : 1),
+            2.2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * appconfI2S_SRC_FACTOR,
+            1.2 * appconfAUDIO_PIPELINE_FRAME_ADVANCE * appconfI2S_SRC_FACTOR,
             appconfI2S2_INTERRUPT_CORE);
 #endif
 }
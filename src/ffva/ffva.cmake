@@ -1,7 +1,7 @@
 #**********************
 # Gather Sources
 #**********************
-file(GLOB_RECURSE APP_SOURCES ${CMAKE_CURRENT_LIST_DIR}/src/*.c )
+file(GLOB_RECURSE APP_SOURCES ${CMAKE_CURRENT_LIST_DIR}/src/*.c ${CMAKE_CURRENT_LIST_DIR}/src/*.cpp)
 set(APP_INCLUDES
     ${CMAKE_CURRENT_LIST_DIR}/src
     ${CMAKE_CURRENT_LIST_DIR}/src/usb
@@ -13,6 +13,27 @@ set(APP_INCLUDES
 
 include(${CMAKE_CURRENT_LIST_DIR}/bsp_config/bsp_config.cmake)
 
+#**********************
+# Wake word model
+#
+# The .tflite file given with -DFFVA_WW_MODEL=<path> is built into the
+# firmware for the wake word engine, which runs when appconfWW_ENABLED is
+# set. Without one, the engine reads its audio and does nothing with it.
+#**********************
+set(FFVA_WW_MODEL "" CACHE FILEPATH "TensorFlow Lite wake word model")
+if(FFVA_WW_MODEL)
+    file(READ ${FFVA_WW_MODEL} WW_MODEL_HEX HEX)
+    string(LENGTH "${WW_MODEL_HEX}" WW_MODEL_SIZE)
+    math(EXPR WW_MODEL_SIZE "${WW_MODEL_SIZE} / 2")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," WW_MODEL_BYTES "${WW_MODEL_HEX}")
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${FFVA_WW_MODEL})
+else()
+    set(WW_MODEL_SIZE 0)
+    set(WW_MODEL_BYTES "0x00,")
+endif()
+configure_file(${CMAKE_CURRENT_LIST_DIR}/src/ww_model_runner/ww_model_data.c.in ${CMAKE_CURRENT_BINARY_DIR}/ww_model_data.c @ONLY)
+list(APPEND APP_SOURCES ${CMAKE_CURRENT_BINARY_DIR}/ww_model_data.c)
+
 #**********************
 # Flags
 #**********************
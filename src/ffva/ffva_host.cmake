@@ -0,0 +1,219 @@
+#**********************
+# Host pipeline runner
+#
+# Builds the reference audio pipelines natively so AEC/IC/NS/AGC tuning can
+# be iterated on WAV files without flashing a board:
+#  example_ffva_host_fixed_delay
+#  example_ffva_host_adec
+#  example_ffva_host_adec_altarch
+#
+# Usage: example_ffva_host_<pipeline> input.wav output.wav
+#**********************
+set(FFVA_HOST_PIPELINES
+    fixed_delay
+    adec
+    adec_altarch
+)
+
+set(FFVA_HOST_SOURCES
+    ${CMAKE_CURRENT_LIST_DIR}/host/src/main.c
+    ${CMAKE_CURRENT_LIST_DIR}/host/src/host_shim.c
+    ${CMAKE_CURRENT_LIST_DIR}/host/src/wav_io.c
+)
+
+# The shim headers must come first so they replace the RTOS headers
+set(FFVA_HOST_INCLUDES
+    ${CMAKE_CURRENT_LIST_DIR}/host/include
+    ${CMAKE_CURRENT_LIST_DIR}/host/src
+    ${CMAKE_CURRENT_LIST_DIR}/src
+)
+
+set(FFVA_HOST_COMPILE_DEFINITIONS
+    MIC_ARRAY_CONFIG_MCLK_FREQ=24576000
+    MIC_ARRAY_CONFIG_PDM_FREQ=3072000
+    MIC_ARRAY_CONFIG_SAMPLES_PER_FRAME=240
+    MIC_ARRAY_CONFIG_MIC_COUNT=2
+)
+
+set(FFVA_HOST_COMPILER_FLAGS
+    -O2
+    -g
+)
+
+# Helper tasks, such as the second AEC thread, run on host threads
+find_package(Threads REQUIRED)
+
+foreach(FFVA_AP ${FFVA_HOST_PIPELINES})
+    set(AP_TARGET sln_voice::app::ffva::ap::${FFVA_AP})
+    get_target_property(AP_SOURCES ${AP_TARGET} INTERFACE_SOURCES)
+    get_target_property(AP_INCLUDES ${AP_TARGET} INTERFACE_INCLUDE_DIRECTORIES)
+    get_target_property(AP_LINK_LIBRARIES ${AP_TARGET} INTERFACE_LINK_LIBRARIES)
+
+    # Both tile halves are linked into one executable, so each is built for
+    # its own tile and given its own init symbol
+    foreach(AP_SOURCE ${AP_SOURCES})
+        if(AP_SOURCE MATCHES "audio_pipeline_t([01])\\.c$")
+            set_source_files_properties(${AP_SOURCE}
+                PROPERTIES
+                    COMPILE_DEFINITIONS "THIS_XCORE_TILE=${CMAKE_MATCH_1};audio_pipeline_init=audio_pipeline_init_tile${CMAKE_MATCH_1}"
+            )
+        endif()
+    endforeach()
+
+    # Only the DSP libraries are wanted, the RTOS is provided by the shim
+    list(FILTER AP_LINK_LIBRARIES INCLUDE REGEX "^fwk_voice::")
+
+    set(TARGET_NAME example_ffva_host_${FFVA_AP})
+    add_executable(${TARGET_NAME})
+    target_sources(${TARGET_NAME} PRIVATE ${FFVA_HOST_SOURCES} ${AP_SOURCES})
+    target_include_directories(${TARGET_NAME} PRIVATE ${FFVA_HOST_INCLUDES} ${AP_INCLUDES})
+    target_compile_definitions(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILE_DEFINITIONS})
+    target_compile_options(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILER_FLAGS})
+    target_link_libraries(${TARGET_NAME} PRIVATE ${AP_LINK_LIBRARIES} Threads::Threads m)
+    install(TARGETS ${TARGET_NAME} DESTINATION ${HOST_INSTALL_DIR})
+    unset(TARGET_NAME)
+endforeach()
+
+#**********************
+# Wake word benchmark
+#
+# Runs the wake word feature frontend and model over a WAV file, and
+# reports the time per feature hop and per model run and the tensor arena
+# high water mark:
+#  example_ffva_host_ww_bench
+#
+# Usage: example_ffva_host_ww_bench model.tflite input.wav
+#**********************
+# The frontend's FFT is from lib_xcore_math, which comes with the DSP libraries
+set(AP_TARGET sln_voice::app::ffva::ap::fixed_delay)
+get_target_property(AP_LINK_LIBRARIES ${AP_TARGET} INTERFACE_LINK_LIBRARIES)
+list(FILTER AP_LINK_LIBRARIES INCLUDE REGEX "^fwk_voice::")
+
+set(TARGET_NAME example_ffva_host_ww_bench)
+add_executable(${TARGET_NAME})
+target_sources(${TARGET_NAME}
+    PRIVATE
+        ${CMAKE_CURRENT_LIST_DIR}/host/src/ww_bench.c
+        ${CMAKE_CURRENT_LIST_DIR}/host/src/wav_io.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/feature_cache/feature_frontend.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/ww_model_runner/ww_inference.cpp
+)
+target_include_directories(${TARGET_NAME} PRIVATE ${FFVA_HOST_INCLUDES})
+target_compile_definitions(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILE_DEFINITIONS} appconfWW_ENABLED=1)
+target_compile_options(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILER_FLAGS})
+target_link_libraries(${TARGET_NAME} PRIVATE inferencing_tflite_micro ${AP_LINK_LIBRARIES} m)
+install(TARGETS ${TARGET_NAME} DESTINATION ${HOST_INSTALL_DIR})
+unset(TARGET_NAME)
+
+#**********************
+# Delay buffer benchmark
+#
+# Times the block delay line of the reference pipelines against the sample
+# at a time one it replaced, and checks they give the same output:
+#  example_ffva_host_delay_buffer_bench
+#
+# Usage: example_ffva_host_delay_buffer_bench [--frames <n>]
+#**********************
+set(AP_TARGET sln_voice::app::ffva::ap::fixed_delay)
+get_target_property(AP_SOURCES ${AP_TARGET} INTERFACE_SOURCES)
+get_target_property(AP_INCLUDES ${AP_TARGET} INTERFACE_INCLUDE_DIRECTORIES)
+get_target_property(AP_LINK_LIBRARIES ${AP_TARGET} INTERFACE_LINK_LIBRARIES)
+list(FILTER AP_SOURCES INCLUDE REGEX "delay_buffer\\.c$")
+list(FILTER AP_LINK_LIBRARIES INCLUDE REGEX "^fwk_voice::")
+
+set(TARGET_NAME example_ffva_host_delay_buffer_bench)
+add_executable(${TARGET_NAME})
+target_sources(${TARGET_NAME}
+    PRIVATE
+        ${CMAKE_CURRENT_LIST_DIR}/host/src/delay_buffer_bench.c
+        ${AP_SOURCES}
+)
+target_include_directories(${TARGET_NAME} PRIVATE ${FFVA_HOST_INCLUDES} ${AP_INCLUDES})
+target_compile_definitions(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILE_DEFINITIONS})
+target_compile_options(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILER_FLAGS})
+target_link_libraries(${TARGET_NAME} PRIVATE ${AP_LINK_LIBRARIES} m)
+install(TARGETS ${TARGET_NAME} DESTINATION ${HOST_INSTALL_DIR})
+unset(TARGET_NAME)
+
+#**********************
+# Configuration store test
+#
+# Runs the configuration store on a model of the flash in RAM, including
+# writes cut short by a reset:
+#  example_ffva_host_config_store_test
+#
+# Usage: example_ffva_host_config_store_test, or ctest
+#**********************
+enable_testing()
+
+set(TARGET_NAME example_ffva_host_config_store_test)
+add_executable(${TARGET_NAME})
+target_sources(${TARGET_NAME}
+    PRIVATE
+        ${CMAKE_CURRENT_LIST_DIR}/host/src/config_store_test.c
+        ${CMAKE_CURRENT_LIST_DIR}/src/configuration/configuration_common.c
+)
+target_include_directories(${TARGET_NAME} PRIVATE ${FFVA_HOST_INCLUDES})
+target_compile_options(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILER_FLAGS})
+add_test(NAME ffva_host_config_store COMMAND ${TARGET_NAME})
+unset(TARGET_NAME)
+
+#**********************
+# PCM16 test
+#
+# Checks the rounding, saturation and gain of the 16 bit PCM kernel used by
+# the S16 intertile format:
+#  example_ffva_host_pcm16_test
+#
+# Usage: example_ffva_host_pcm16_test, or ctest
+#**********************
+set(AP_TARGET sln_voice::app::ffva::ap::fixed_delay)
+get_target_property(AP_SOURCES ${AP_TARGET} INTERFACE_SOURCES)
+get_target_property(AP_INCLUDES ${AP_TARGET} INTERFACE_INCLUDE_DIRECTORIES)
+get_target_property(AP_LINK_LIBRARIES ${AP_TARGET} INTERFACE_LINK_LIBRARIES)
+list(FILTER AP_SOURCES INCLUDE REGEX "pcm16\\.c$")
+list(FILTER AP_LINK_LIBRARIES INCLUDE REGEX "^fwk_voice::")
+
+set(TARGET_NAME example_ffva_host_pcm16_test)
+add_executable(${TARGET_NAME})
+target_sources(${TARGET_NAME}
+    PRIVATE
+        ${CMAKE_CURRENT_LIST_DIR}/host/src/pcm16_test.c
+        ${AP_SOURCES}
+)
+target_include_directories(${TARGET_NAME} PRIVATE ${FFVA_HOST_INCLUDES} ${AP_INCLUDES})
+target_compile_options(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILER_FLAGS})
+target_link_libraries(${TARGET_NAME} PRIVATE ${AP_LINK_LIBRARIES} m)
+add_test(NAME ffva_host_pcm16 COMMAND ${TARGET_NAME})
+unset(TARGET_NAME)
+
+#**********************
+# AEC threads test
+#
+# Runs the 1 and 2 thread AEC of the fixed delay pipeline on the same
+# frames, and checks their outputs match bit for bit:
+#  example_ffva_host_aec_threads_test
+#
+# Usage: example_ffva_host_aec_threads_test, or ctest
+#**********************
+set(AP_TARGET sln_voice::app::ffva::ap::fixed_delay)
+get_target_property(AP_SOURCES ${AP_TARGET} INTERFACE_SOURCES)
+get_target_property(AP_INCLUDES ${AP_TARGET} INTERFACE_INCLUDE_DIRECTORIES)
+get_target_property(AP_LINK_LIBRARIES ${AP_TARGET} INTERFACE_LINK_LIBRARIES)
+list(FILTER AP_SOURCES INCLUDE REGEX "aec_process_frame_[12]threads?\\.c$")
+list(FILTER AP_LINK_LIBRARIES INCLUDE REGEX "^fwk_voice::")
+
+set(TARGET_NAME example_ffva_host_aec_threads_test)
+add_executable(${TARGET_NAME})
+target_sources(${TARGET_NAME}
+    PRIVATE
+        ${CMAKE_CURRENT_LIST_DIR}/host/src/aec_threads_test.c
+        ${CMAKE_CURRENT_LIST_DIR}/host/src/host_shim.c
+        ${AP_SOURCES}
+)
+target_include_directories(${TARGET_NAME} PRIVATE ${FFVA_HOST_INCLUDES} ${AP_INCLUDES})
+target_compile_definitions(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILE_DEFINITIONS})
+target_compile_options(${TARGET_NAME} PRIVATE ${FFVA_HOST_COMPILER_FLAGS})
+target_link_libraries(${TARGET_NAME} PRIVATE ${AP_LINK_LIBRARIES} Threads::Threads m)
+add_test(NAME ffva_host_aec_threads COMMAND ${TARGET_NAME})
+unset(TARGET_NAME)
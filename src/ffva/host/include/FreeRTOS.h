@@ -0,0 +1,58 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+
+/*
+ * Minimal FreeRTOS shim used to build the reference audio pipelines for the
+ * host. Only the subset of the kernel API used by the pipeline sources is
+ * provided. The pipelines run on a single host thread, so the blocking
+ * calls on queues, stream buffers and the intertile link never block. Only
+ * tasks created with xTaskCreate() get a thread of their own.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "xcore/assert.h"
+#include "rtos_printf.h"
+
+#ifndef THIS_XCORE_TILE
+#define THIS_XCORE_TILE 0
+#endif
+
+#define ON_TILE(t) (THIS_XCORE_TILE == (t))
+
+#define DWORD_ALIGNED __attribute__((aligned(8)))
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdFALSE  ((BaseType_t) 0)
+#define pdTRUE   ((BaseType_t) 1)
+#define pdPASS   (pdTRUE)
+#define pdFAIL   (pdFALSE)
+
+#define portMAX_DELAY ((TickType_t) 0xffffffffUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t) (ms))
+
+#define configSTACK_DEPTH_TYPE      uint32_t
+#define configMINIMAL_STACK_SIZE    ((configSTACK_DEPTH_TYPE) 256)
+#define configMAX_PRIORITIES        32
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2
+#define RTOS_THREAD_STACK_SIZE(f)   0
+
+#define configASSERT(x) assert(x)
+
+void *pvPortMalloc(size_t size);
+void vPortFree(void *ptr);
+size_t xPortGetFreeHeapSize(void);
+size_t xPortGetMinimumEverFreeHeapSize(void);
+
+#endif /* HOST_FREERTOS_H_ */
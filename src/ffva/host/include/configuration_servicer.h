@@ -0,0 +1,20 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#pragma once
+
+/*
+ * Host replacement for the configuration servicer. Only the functions the
+ * pipelines call are provided; the host runner implements them.
+ */
+
+enum e_pipeline_processing_stages
+{
+    PIPELINE_STAGE_NONE = 0,
+    PIPELINE_STAGE_AEC = 1,
+    PIPELINE_STAGE_IC = 2,
+    PIPELINE_STAGE_NS = 3,
+    PIPELINE_STAGE_AGC = 4,
+};
+
+void configuration_push_vnr_value(int value);
@@ -0,0 +1,34 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_GENERIC_PIPELINE_H_
+#define HOST_GENERIC_PIPELINE_H_
+
+#include "FreeRTOS.h"
+
+typedef void * (*pipeline_input_t)(void *);
+typedef int (*pipeline_output_t)(void *, void *);
+typedef void (*pipeline_stage_t)(void *);
+
+/*
+ * On the host the pipeline is not started as a chain of tasks. It is
+ * registered here and then run one frame at a time by
+ * host_pipeline_run_frame(), in the order the pipelines were initialised.
+ */
+void generic_pipeline_init(
+        const pipeline_input_t input,
+        const pipeline_output_t output,
+        void * const input_data,
+        void * const output_data,
+        const pipeline_stage_t * const stage_functions,
+        const size_t * const stage_stack_sizes,
+        const int pipeline_priority,
+        const int stage_count);
+
+/* Returns the number of registered pipelines */
+int host_pipeline_count(void);
+
+/* Runs one frame through registered pipeline `index` */
+void host_pipeline_run_frame(int index);
+
+#endif /* HOST_GENERIC_PIPELINE_H_ */
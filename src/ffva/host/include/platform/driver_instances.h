@@ -0,0 +1,37 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef DRIVER_INSTANCES_H_
+#define DRIVER_INSTANCES_H_
+
+#include "FreeRTOS.h"
+#include "rtos_qspi_flash.h"
+#include "rtos_dfu_image.h"
+
+/* Tile specifiers */
+#define FLASH_TILE_NO      0
+#define I2C_TILE_NO        0
+#define I2C_CTRL_TILE_NO   I2C_TILE_NO
+#define MICARRAY_TILE_NO   1
+#define I2S_TILE_NO        1
+#define I2S2_TILE_NO       0
+
+/*
+ * In-process replacement for the intertile driver. Each port is a FIFO of
+ * messages shared by both "tiles" of the host process.
+ */
+typedef struct host_intertile rtos_intertile_t;
+
+void rtos_intertile_tx(rtos_intertile_t *ctx, uint8_t port, const void *msg, size_t len);
+void rtos_intertile_tx_len(rtos_intertile_t *ctx, uint8_t port, size_t len);
+size_t rtos_intertile_tx_data(rtos_intertile_t *ctx, void *data, size_t len);
+size_t rtos_intertile_rx_len(rtos_intertile_t *ctx, uint8_t port, unsigned timeout);
+size_t rtos_intertile_rx_data(rtos_intertile_t *ctx, void *data, size_t len);
+
+extern rtos_intertile_t *intertile_ctx;
+
+/* Defined by the host programs that use flash */
+extern rtos_qspi_flash_t *qspi_flash_ctx;
+extern rtos_dfu_image_t *dfu_image_ctx;
+
+#endif /* DRIVER_INSTANCES_H_ */
@@ -0,0 +1,9 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef PLATFORM_CONF_H_
+#define PLATFORM_CONF_H_
+
+/* The host builds take their settings from app_conf.h and the compile definitions */
+
+#endif /* PLATFORM_CONF_H_ */
@@ -0,0 +1,9 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_QUADFLASHLIB_H_
+#define HOST_QUADFLASHLIB_H_
+
+/* Nothing from libquadflash is used on the host, flash is reached through rtos_qspi_flash.h */
+
+#endif /* HOST_QUADFLASHLIB_H_ */
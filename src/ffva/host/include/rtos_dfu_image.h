@@ -0,0 +1,12 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_RTOS_DFU_IMAGE_H_
+#define HOST_RTOS_DFU_IMAGE_H_
+
+/* DFU image driver API, implemented by the host program that needs it */
+typedef struct host_dfu_image rtos_dfu_image_t;
+
+unsigned rtos_dfu_image_get_data_partition_addr(rtos_dfu_image_t *ctx);
+
+#endif /* HOST_RTOS_DFU_IMAGE_H_ */
@@ -0,0 +1,12 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_RTOS_OSAL_H_
+#define HOST_RTOS_OSAL_H_
+
+#include <stdlib.h>
+
+#define rtos_osal_malloc(size)  malloc(size)
+#define rtos_osal_free(ptr)     free(ptr)
+
+#endif /* HOST_RTOS_OSAL_H_ */
@@ -0,0 +1,12 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_RTOS_PRINTF_H_
+#define HOST_RTOS_PRINTF_H_
+
+#include <stdio.h>
+
+#define rtos_printf printf
+#define debug_printf printf
+
+#endif /* HOST_RTOS_PRINTF_H_ */
@@ -0,0 +1,26 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_RTOS_QSPI_FLASH_H_
+#define HOST_RTOS_QSPI_FLASH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "rtos_osal.h"
+
+/*
+ * QSPI flash driver API, implemented by the host program that needs it,
+ * typically as a model of the flash in RAM.
+ */
+typedef struct host_qspi_flash rtos_qspi_flash_t;
+
+void rtos_qspi_flash_lock(rtos_qspi_flash_t *ctx);
+void rtos_qspi_flash_unlock(rtos_qspi_flash_t *ctx);
+void rtos_qspi_flash_read(rtos_qspi_flash_t *ctx, uint8_t *data, unsigned address, size_t len);
+void rtos_qspi_flash_write(rtos_qspi_flash_t *ctx, const uint8_t *data, unsigned address, size_t len);
+void rtos_qspi_flash_erase(rtos_qspi_flash_t *ctx, unsigned address, size_t len);
+size_t rtos_qspi_flash_size_get(rtos_qspi_flash_t *ctx);
+size_t rtos_qspi_flash_sector_size_get(rtos_qspi_flash_t *ctx);
+
+#endif /* HOST_RTOS_QSPI_FLASH_H_ */
@@ -0,0 +1,33 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_TASK_H_
+#define HOST_TASK_H_
+
+#include "FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+
+#define taskYIELD()
+
+/* Only used around pipeline settings, which the host sets before it runs */
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define vTaskDelay(ticks) ((void) (ticks))
+
+/*
+ * Tasks created with xTaskCreate() run on their own host thread, so helper
+ * tasks that a pipeline stage hands work to run alongside it. Only direct to
+ * task notifications are provided for them to synchronise with.
+ */
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode,
+                       const char * const pcName,
+                       const configSTACK_DEPTH_TYPE usStackDepth,
+                       void * const pvParameters,
+                       UBaseType_t uxPriority,
+                       TaskHandle_t * const pxCreatedTask);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify);
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+
+#endif /* HOST_TASK_H_ */
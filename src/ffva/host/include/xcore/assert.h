@@ -0,0 +1,13 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_XCORE_ASSERT_H_
+#define HOST_XCORE_ASSERT_H_
+
+#include <assert.h>
+
+#ifndef xassert
+#define xassert(e) assert(e)
+#endif
+
+#endif /* HOST_XCORE_ASSERT_H_ */
@@ -0,0 +1,18 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_XCORE_HWTIMER_H_
+#define HOST_XCORE_HWTIMER_H_
+
+#include <stdint.h>
+#include <time.h>
+
+/* Returns a free running 100 MHz count, like the xcore reference clock */
+static inline uint32_t get_reference_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) ((uint64_t) ts.tv_sec * 100000000 + (uint64_t) ts.tv_nsec / 10);
+}
+
+#endif /* HOST_XCORE_HWTIMER_H_ */
@@ -0,0 +1,103 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* App headers */
+#include "app_conf.h"
+#include "audio_pipeline_dsp.h"
+
+/*
+ * Host test that the 2 thread AEC gives the same output as the 1 thread
+ * one, bit for bit.
+ *
+ * Two AECs are set up the same way and fed the same frames, one through
+ * aec_process_frame_1thread() and one through aec_process_frame_2threads(),
+ * whose helper runs on a host thread. The mics are the reference through a
+ * short echo path plus a little noise, so the filters adapt and the main
+ * and shadow filters are compared and copied along the way. The main and
+ * shadow outputs of every frame must match.
+ *
+ * Returns 1 at the first frame that differs.
+ */
+
+#define TEST_FRAMES     (400)
+#define ECHO_HISTORY    (16)    /* Power of two, longer than the echo path */
+
+static aec_ctx_t DWORD_ALIGNED aec_1thread;
+static aec_ctx_t DWORD_ALIGNED aec_2threads;
+
+static void aec_setup(aec_ctx_t *ctx)
+{
+    aec_init(&ctx->aec_main_state,
+             &ctx->aec_shadow_state,
+             &ctx->aec_shared_state,
+             &ctx->aec_main_memory_pool[0],
+             &ctx->aec_shadow_memory_pool[0],
+             AEC_MAX_Y_CHANNELS,
+             AEC_MAX_X_CHANNELS,
+             AEC_MAIN_FILTER_PHASES,
+             AEC_SHADOW_FILTER_PHASES);
+}
+
+static int32_t noise(uint32_t *seed, int shr)
+{
+    *seed = *seed * 1664525 + 1013904223;
+    return (int32_t) *seed >> shr;
+}
+
+/* Reference noise, and mics that hear it through a fixed echo path */
+static void make_frame(int32_t (*y)[AEC_FRAME_ADVANCE], int32_t (*x)[AEC_FRAME_ADVANCE], uint32_t *seed)
+{
+    static int32_t history[AEC_MAX_X_CHANNELS][ECHO_HISTORY];
+    static uint32_t n;
+
+    for (int i = 0; i < AEC_FRAME_ADVANCE; i++, n++) {
+        for (int ch = 0; ch < AEC_MAX_X_CHANNELS; ch++) {
+            x[ch][i] = noise(seed, 3);
+            history[ch][n & (ECHO_HISTORY - 1)] = x[ch][i];
+        }
+        y[0][i] = (history[0][(n - 3) & (ECHO_HISTORY - 1)] >> 1) +
+                  (history[1][(n - 7) & (ECHO_HISTORY - 1)] >> 2) +
+                  noise(seed, 10);
+        y[1][i] = (history[0][(n - 5) & (ECHO_HISTORY - 1)] >> 2) +
+                  (history[1][(n - 2) & (ECHO_HISTORY - 1)] >> 1) +
+                  noise(seed, 10);
+    }
+}
+
+int main(void)
+{
+    int32_t DWORD_ALIGNED y[AEC_MAX_Y_CHANNELS][AEC_FRAME_ADVANCE];
+    int32_t DWORD_ALIGNED x[AEC_MAX_X_CHANNELS][AEC_FRAME_ADVANCE];
+    int32_t DWORD_ALIGNED main_1thread[AEC_MAX_Y_CHANNELS][AEC_FRAME_ADVANCE];
+    int32_t DWORD_ALIGNED shadow_1thread[AEC_MAX_Y_CHANNELS][AEC_FRAME_ADVANCE];
+    int32_t DWORD_ALIGNED main_2threads[AEC_MAX_Y_CHANNELS][AEC_FRAME_ADVANCE];
+    int32_t DWORD_ALIGNED shadow_2threads[AEC_MAX_Y_CHANNELS][AEC_FRAME_ADVANCE];
+    uint32_t seed = 1;
+
+    aec_setup(&aec_1thread);
+    aec_setup(&aec_2threads);
+    aec_process_frame_2threads_init(appconfAUDIO_PIPELINE_TASK_PRIORITY);
+
+    for (int frame = 0; frame < TEST_FRAMES; frame++) {
+        make_frame(y, x, &seed);
+
+        aec_process_frame_1thread(&aec_1thread.aec_main_state, &aec_1thread.aec_shadow_state,
+                                  main_1thread, shadow_1thread, y, x);
+        aec_process_frame_2threads(&aec_2threads.aec_main_state, &aec_2threads.aec_shadow_state,
+                                   main_2threads, shadow_2threads, y, x);
+
+        if (memcmp(main_1thread, main_2threads, sizeof(main_1thread)) != 0 ||
+            memcmp(shadow_1thread, shadow_2threads, sizeof(shadow_1thread)) != 0) {
+            printf("FAIL: the 1 and 2 thread AEC outputs differ at frame %d\n", frame);
+            return 1;
+        }
+    }
+
+    printf("pass: %d frames, the 1 and 2 thread AEC outputs match\n", TEST_FRAMES);
+    return 0;
+}
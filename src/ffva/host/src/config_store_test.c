@@ -0,0 +1,195 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* App headers */
+#include "platform/driver_instances.h"
+#include "configuration/configuration_common.h"
+
+/*
+ * Host test for the configuration store.
+ *
+ * The store runs on a model of the QSPI flash in RAM, where a write can
+ * only clear bits and an erase sets a whole sector to 0xFF. The model can
+ * cut a write short, as a reset would, to check that the store comes back
+ * with the values written before it.
+ *
+ * Prints the result of each check, and returns 1 if any failed.
+ */
+
+#define FLASH_BYTES         (1024 * 1024)
+#define SECTOR_BYTES        (4096)
+#define DATA_PARTITION      (FLASH_BYTES / 2)
+
+static uint8_t flash[FLASH_BYTES];
+static unsigned sector_erases[FLASH_BYTES / SECTOR_BYTES];
+static long write_limit = -1;   /* Bytes written before the reset, -1 for none */
+static int failures = 0;
+
+rtos_qspi_flash_t *qspi_flash_ctx = NULL;
+rtos_dfu_image_t *dfu_image_ctx = NULL;
+
+void rtos_qspi_flash_lock(rtos_qspi_flash_t *ctx) { (void) ctx; }
+void rtos_qspi_flash_unlock(rtos_qspi_flash_t *ctx) { (void) ctx; }
+
+void rtos_qspi_flash_read(rtos_qspi_flash_t *ctx, uint8_t *data, unsigned address, size_t len)
+{
+    (void) ctx;
+    memcpy(data, &flash[address], len);
+}
+
+void rtos_qspi_flash_write(rtos_qspi_flash_t *ctx, const uint8_t *data, unsigned address, size_t len)
+{
+    (void) ctx;
+    for (size_t i = 0; i < len && write_limit != 0; i++) {
+        flash[address + i] &= data[i];
+        if (write_limit > 0) {
+            write_limit--;
+        }
+    }
+}
+
+void rtos_qspi_flash_erase(rtos_qspi_flash_t *ctx, unsigned address, size_t len)
+{
+    (void) ctx;
+    memset(&flash[address], 0xFF, len);
+    for (size_t s = address / SECTOR_BYTES; s < (address + len) / SECTOR_BYTES; s++) {
+        sector_erases[s]++;
+    }
+}
+
+size_t rtos_qspi_flash_size_get(rtos_qspi_flash_t *ctx)
+{
+    (void) ctx;
+    return FLASH_BYTES;
+}
+
+size_t rtos_qspi_flash_sector_size_get(rtos_qspi_flash_t *ctx)
+{
+    (void) ctx;
+    return SECTOR_BYTES;
+}
+
+unsigned rtos_dfu_image_get_data_partition_addr(rtos_dfu_image_t *ctx)
+{
+    (void) ctx;
+    return DATA_PARTITION;
+}
+
+static void check(int ok, const char *what)
+{
+    printf("%s: %s\n", ok ? "pass" : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static void make_value(uint8_t *value, uint16_t length, uint32_t seed)
+{
+    for (uint16_t i = 0; i < length; i++) {
+        seed = seed * 1664525 + 1013904223;
+        value[i] = seed >> 24;
+    }
+}
+
+static int value_is(uint8_t key, const uint8_t *expected, uint16_t length)
+{
+    uint8_t value[CONFIGURATION_STORE_MAX_VALUE];
+    return configuration_store_read(key, value, sizeof(value)) == length &&
+           memcmp(value, expected, length) == 0;
+}
+
+int main(void)
+{
+    static uint8_t latest[CONFIGURATION_STORE_MAX_KEYS][CONFIGURATION_STORE_MAX_VALUE];
+    static uint16_t latest_length[CONFIGURATION_STORE_MAX_KEYS];
+    uint8_t value[CONFIGURATION_STORE_MAX_VALUE + 1];
+    int ok;
+
+    memset(flash, 0xFF, sizeof(flash));
+    check(configuration_init() == 0, "an erased store is opened");
+    check(configuration_store_read(5, value, sizeof(value)) == 0, "a key never written reads back empty");
+
+    /* Enough writes to fill the store's sectors many times over */
+    for (uint32_t n = 0; n < 20000; n++) {
+        const uint8_t key = (n * 7) % CONFIGURATION_STORE_MAX_KEYS;
+        const uint16_t length = 1 + (n % CONFIGURATION_STORE_MAX_VALUE);
+        make_value(latest[key], length, n);
+        latest_length[key] = length;
+        if (configuration_store_write(key, latest[key], length) != 0) {
+            break;
+        }
+    }
+
+    ok = 1;
+    for (uint8_t key = 0; key < CONFIGURATION_STORE_MAX_KEYS; key++) {
+        ok &= value_is(key, latest[key], latest_length[key]);
+    }
+    check(ok, "each key reads back its latest value");
+
+    configuration_init();
+    ok = 1;
+    for (uint8_t key = 0; key < CONFIGURATION_STORE_MAX_KEYS; key++) {
+        ok &= value_is(key, latest[key], latest_length[key]);
+    }
+    check(ok, "each key reads back its latest value after a reset");
+
+    unsigned min_erases = ~0u;
+    unsigned max_erases = 0;
+    for (unsigned s = 0; s < FLASH_BYTES / SECTOR_BYTES; s++) {
+        if (s * SECTOR_BYTES >= FLASH_BYTES - (CONFIGURATION_STORE_SECTORS + 1) * SECTOR_BYTES &&
+            s * SECTOR_BYTES < FLASH_BYTES - SECTOR_BYTES) {
+            if (sector_erases[s] < min_erases) min_erases = sector_erases[s];
+            if (sector_erases[s] > max_erases) max_erases = sector_erases[s];
+        } else if (sector_erases[s] != 0) {
+            max_erases = ~0u;
+        }
+    }
+    printf("store sector erases: min %u, max %u\n", min_erases, max_erases);
+    check(min_erases > 0 && max_erases - min_erases <= 1, "erases are spread over the store's sectors only");
+
+    /* A reset part way through each byte of a record keeps the value before it */
+    ok = 1;
+    for (long cut = 0; cut < 8 + CONFIGURATION_STORE_MAX_VALUE; cut++) {
+        make_value(value, CONFIGURATION_STORE_MAX_VALUE, 100000 + cut);
+        write_limit = cut;
+        configuration_store_write(3, value, CONFIGURATION_STORE_MAX_VALUE);
+        write_limit = -1;
+
+        configuration_init();
+        ok &= value_is(3, latest[3], latest_length[3]);
+        ok &= value_is(4, latest[4], latest_length[4]);
+
+        /* The store is usable again straight away */
+        make_value(latest[4], 16, 200000 + cut);
+        latest_length[4] = 16;
+        ok &= configuration_store_write(4, latest[4], 16) == 0;
+        configuration_init();
+        ok &= value_is(4, latest[4], 16);
+        ok &= value_is(3, latest[3], latest_length[3]);
+    }
+    check(ok, "a write cut short by a reset leaves the earlier values");
+
+    memset(value, 0x5A, sizeof(value));
+    check(configuration_store_write(6, value, CONFIGURATION_STORE_MAX_VALUE + 1) == 3,
+          "a value over CONFIGURATION_STORE_MAX_VALUE is rejected");
+    check(configuration_store_write(CONFIGURATION_STORE_MAX_KEYS, value, 1) == 4, "an unknown key is rejected");
+
+    const uint8_t zone[] = "customer";
+    uint8_t zone_read[CONFIGURATION_STORE_MAX_VALUE];
+    check(configuration_write_to_flash(CONFIGURATION_CUSTOMER_ZONE, zone, sizeof(zone)) == 0 &&
+          configuration_read_from_flash(CONFIGURATION_CUSTOMER_ZONE, zone_read, sizeof(zone_read)) == 0 &&
+          memcmp(zone_read, zone, sizeof(zone)) == 0 && zone_read[sizeof(zone)] == 0xFF,
+          "the customer zone reads back, then 0xFF");
+    check(configuration_write_to_flash(CONFIGURATION_CUSTOMER_ZONE, value, CONFIGURATION_STORE_MAX_VALUE + 1) == 3,
+          "a customer zone write over CONFIGURATION_STORE_MAX_VALUE is rejected");
+    check(configuration_write_to_flash(CONFIGURATION_FACTORY_ZONE, zone, sizeof(zone)) == 2,
+          "the factory zone cannot be written");
+
+    printf("%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
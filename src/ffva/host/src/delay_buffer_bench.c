@@ -0,0 +1,166 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Shim headers */
+#include <xcore/hwtimer.h>
+
+/* App headers */
+#include "delay_buffer.h"
+
+/*
+ * Host benchmark for the delay line.
+ *
+ * Pseudo random frames of MAX_DELAY_BUF_CHANNELS channels are delayed by
+ * get_delayed_samples(), and by the sample at a time delay line it
+ * replaced, kept here as it was. Each frame is timed for both, and the
+ * two outputs must match. Timings are in ticks of the 100 MHz reference
+ * clock, and are for this host, not for an xcore.
+ *
+ * With --frames, the given number of frames is run per delay instead.
+ *
+ * Returns 1 if the outputs differ.
+ */
+
+#define TICKS_PER_US    (100)
+#define DEFAULT_FRAMES  (10000)
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} ticks_stats_t;
+
+static void ticks_add(ticks_stats_t *stats, uint32_t ticks)
+{
+    if (stats->count == 0 || ticks < stats->min) stats->min = ticks;
+    if (ticks > stats->max) stats->max = ticks;
+    stats->total += ticks;
+    stats->count++;
+}
+
+static void ticks_print(const char *name, const ticks_stats_t *stats)
+{
+    uint32_t avg = stats->count ? (uint32_t) (stats->total / stats->count) : 0;
+
+    printf("  %-10s %8u frames, ticks min %6u avg %6u max %8u, avg %.2f us\n",
+           name, (unsigned) stats->count,
+           (unsigned) stats->min, (unsigned) avg, (unsigned) stats->max,
+           (double) avg / TICKS_PER_US);
+}
+
+/* The sample at a time delay line, two modulos and a call per sample */
+typedef struct {
+    int32_t delay_buffer[MAX_DELAY_BUF_CHANNELS][DELAY_BUF_MAX_DELAY_SAMPLES];
+    int32_t curr_idx[MAX_DELAY_BUF_CHANNELS];
+    int32_t delay_samples;
+} per_sample_state_t;
+
+static void __attribute__((noinline)) get_delayed_sample(per_sample_state_t *delay_state, int32_t *sample, int32_t ch)
+{
+    delay_state->delay_buffer[ch][delay_state->curr_idx[ch]] = *sample;
+    int32_t abs_delay_samples = (delay_state->delay_samples < 0) ? -delay_state->delay_samples : delay_state->delay_samples;
+    uint32_t delay_idx = (
+            (DELAY_BUF_MAX_DELAY_SAMPLES + delay_state->curr_idx[ch] - abs_delay_samples)
+            % DELAY_BUF_MAX_DELAY_SAMPLES
+            );
+    *sample = delay_state->delay_buffer[ch][delay_idx];
+    delay_state->curr_idx[ch] = (delay_state->curr_idx[ch] + 1) % DELAY_BUF_MAX_DELAY_SAMPLES;
+}
+
+static void fill_frame(int32_t (*frame)[AP_FRAME_ADVANCE], uint32_t *seed)
+{
+    for (int ch = 0; ch < MAX_DELAY_BUF_CHANNELS; ch++) {
+        for (int i = 0; i < AP_FRAME_ADVANCE; i++) {
+            *seed = *seed * 1664525 + 1013904223;
+            frame[ch][i] = (int32_t) *seed;
+        }
+    }
+}
+
+/* Returns 0 if both delay lines gave the same output for every frame */
+static int run_delay(int32_t delay_samples, uint32_t frames)
+{
+    static delay_buf_state_t block_state;
+    static per_sample_state_t sample_state;
+    int32_t block[MAX_DELAY_BUF_CHANNELS][AP_FRAME_ADVANCE];
+    int32_t sample[MAX_DELAY_BUF_CHANNELS][AP_FRAME_ADVANCE];
+    ticks_stats_t block_stats = {0};
+    ticks_stats_t sample_stats = {0};
+    uint32_t seed = 1;
+    int mismatches = 0;
+
+    delay_buffer_init(&block_state, delay_samples);
+    memset(&sample_state, 0, sizeof(sample_state));
+    sample_state.delay_samples = delay_samples;
+
+    for (uint32_t f = 0; f < frames; f++) {
+        fill_frame(block, &seed);
+        memcpy(sample, block, sizeof(sample));
+
+        uint32_t start = get_reference_time();
+        for (int ch = 0; ch < MAX_DELAY_BUF_CHANNELS; ch++) {
+            get_delayed_samples(&block_state, &block[ch][0], ch, AP_FRAME_ADVANCE);
+        }
+        ticks_add(&block_stats, get_reference_time() - start);
+
+        start = get_reference_time();
+        for (int ch = 0; ch < MAX_DELAY_BUF_CHANNELS; ch++) {
+            for (int i = 0; i < AP_FRAME_ADVANCE; i++) {
+                get_delayed_sample(&sample_state, &sample[ch][i], ch);
+            }
+        }
+        ticks_add(&sample_stats, get_reference_time() - start);
+
+        if (memcmp(block, sample, sizeof(block)) != 0) {
+            mismatches++;
+        }
+    }
+
+    printf("Delay of %d samples:\n", (int) delay_samples);
+    ticks_print("block", &block_stats);
+    ticks_print("per sample", &sample_stats);
+    if (mismatches) {
+        printf("  FAIL: %d frames differ\n", mismatches);
+    }
+    return mismatches != 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [--frames <n>]\n", name);
+    fprintf(stderr, "  n            frames run per delay, default %d\n", DEFAULT_FRAMES);
+}
+
+int main(int argc, char **argv)
+{
+    /* The per sample line is DELAY_BUF_MAX_DELAY_SAMPLES long, so it can delay by one less */
+    const int32_t delays[] = {
+        1,
+        AP_FRAME_ADVANCE / 2,
+        AP_FRAME_ADVANCE * 3 + 7,
+        -(AP_FRAME_ADVANCE * 3 + 7),
+        DELAY_BUF_MAX_DELAY_SAMPLES - 1,
+    };
+    uint32_t frames = DEFAULT_FRAMES;
+    int failed = 0;
+
+    if (argc == 3 && strcmp(argv[1], "--frames") == 0) {
+        frames = strtoul(argv[2], NULL, 0);
+    } else if (argc != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        failed |= run_delay(delays[i], frames);
+    }
+
+    return failed;
+}
@@ -0,0 +1,409 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+/* Shim headers */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stream_buffer.h"
+#include "generic_pipeline.h"
+#include "platform/driver_instances.h"
+
+/* App headers */
+#include "audio_pipeline.h"
+
+/*
+ * Heap
+ */
+typedef struct {
+    size_t size;
+    uint64_t pad;   /* Keeps the returned pointer double word aligned */
+} heap_hdr_t;
+
+static size_t heap_in_use;
+static size_t heap_high_water;
+
+void *pvPortMalloc(size_t size)
+{
+    heap_hdr_t *hdr = malloc(sizeof(heap_hdr_t) + size);
+    configASSERT(hdr != NULL);
+
+    hdr->size = size;
+    heap_in_use += size;
+    if (heap_in_use > heap_high_water) {
+        heap_high_water = heap_in_use;
+    }
+    return hdr + 1;
+}
+
+void vPortFree(void *ptr)
+{
+    if (ptr != NULL) {
+        heap_hdr_t *hdr = (heap_hdr_t *) ptr - 1;
+        heap_in_use -= hdr->size;
+        free(hdr);
+    }
+}
+
+size_t xPortGetFreeHeapSize(void)
+{
+    return SIZE_MAX - heap_in_use;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    return SIZE_MAX - heap_high_water;
+}
+
+/*
+ * Tasks
+ */
+struct host_task {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+    TaskFunction_t code;
+    void *params;
+};
+
+static __thread TaskHandle_t host_current_task;
+
+static TaskHandle_t host_task_alloc(void)
+{
+    /* Not from pvPortMalloc(), which is only used by the pipeline thread */
+    TaskHandle_t task = calloc(1, sizeof(struct host_task));
+    configASSERT(task != NULL);
+
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    return task;
+}
+
+static void *host_task_entry(void *arg)
+{
+    TaskHandle_t task = arg;
+
+    host_current_task = task;
+    task->code(task->params);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode,
+                       const char * const pcName,
+                       const configSTACK_DEPTH_TYPE usStackDepth,
+                       void * const pvParameters,
+                       UBaseType_t uxPriority,
+                       TaskHandle_t * const pxCreatedTask)
+{
+    (void) pcName;
+    (void) usStackDepth;
+    (void) uxPriority;
+    TaskHandle_t task = host_task_alloc();
+
+    task->code = pxTaskCode;
+    task->params = pvParameters;
+    if (pthread_create(&task->thread, NULL, host_task_entry, task) != 0) {
+        return pdFAIL;
+    }
+    /* Tasks run forever, the process exits without joining them */
+    pthread_detach(task->thread);
+
+    if (pxCreatedTask != NULL) {
+        *pxCreatedTask = task;
+    }
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    /* The main thread gets a handle the first time it asks */
+    if (host_current_task == NULL) {
+        host_current_task = host_task_alloc();
+        host_current_task->thread = pthread_self();
+    }
+    return host_current_task;
+}
+
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify)
+{
+    configASSERT(uxIndexToNotify < configTASK_NOTIFICATION_ARRAY_ENTRIES);
+
+    pthread_mutex_lock(&xTaskToNotify->lock);
+    xTaskToNotify->notify[uxIndexToNotify]++;
+    pthread_cond_signal(&xTaskToNotify->cond);
+    pthread_mutex_unlock(&xTaskToNotify->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    uint32_t count;
+
+    configASSERT(uxIndexToWaitOn < configTASK_NOTIFICATION_ARRAY_ENTRIES);
+
+    pthread_mutex_lock(&task->lock);
+    while (task->notify[uxIndexToWaitOn] == 0 && xTicksToWait != 0) {
+        pthread_cond_wait(&task->cond, &task->lock);
+    }
+    count = task->notify[uxIndexToWaitOn];
+    if (count > 0) {
+        task->notify[uxIndexToWaitOn] = xClearCountOnExit ? 0 : count - 1;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return count;
+}
+
+/*
+ * Stream buffer
+ */
+struct host_stream_buffer {
+    uint8_t *buf;
+    size_t size;
+    size_t head;
+    size_t count;
+};
+
+StreamBufferHandle_t xStreamBufferCreate(size_t xBufferSizeBytes, size_t xTriggerLevelBytes)
+{
+    (void) xTriggerLevelBytes;
+    StreamBufferHandle_t sb = pvPortMalloc(sizeof(struct host_stream_buffer));
+
+    sb->buf = pvPortMalloc(xBufferSizeBytes);
+    sb->size = xBufferSizeBytes;
+    sb->head = 0;
+    sb->count = 0;
+    return sb;
+}
+
+void vStreamBufferDelete(StreamBufferHandle_t xStreamBuffer)
+{
+    vPortFree(xStreamBuffer->buf);
+    vPortFree(xStreamBuffer);
+}
+
+size_t xStreamBufferSend(StreamBufferHandle_t xStreamBuffer, const void *pvTxData, size_t xDataLengthBytes, TickType_t xTicksToWait)
+{
+    (void) xTicksToWait;
+    StreamBufferHandle_t sb = xStreamBuffer;
+    const uint8_t *src = pvTxData;
+    size_t n = sb->size - sb->count;
+
+    if (xDataLengthBytes < n) {
+        n = xDataLengthBytes;
+    }
+    for (size_t i = 0; i < n; i++) {
+        sb->buf[(sb->head + sb->count + i) % sb->size] = src[i];
+    }
+    sb->count += n;
+    return n;
+}
+
+size_t xStreamBufferReceive(StreamBufferHandle_t xStreamBuffer, void *pvRxData, size_t xBufferLengthBytes, TickType_t xTicksToWait)
+{
+    (void) xTicksToWait;
+    StreamBufferHandle_t sb = xStreamBuffer;
+    uint8_t *dst = pvRxData;
+    size_t n = sb->count;
+
+    if (xBufferLengthBytes < n) {
+        n = xBufferLengthBytes;
+    }
+    for (size_t i = 0; i < n; i++) {
+        dst[i] = sb->buf[(sb->head + i) % sb->size];
+    }
+    sb->head = (sb->head + n) % sb->size;
+    sb->count -= n;
+    return n;
+}
+
+size_t xStreamBufferBytesAvailable(StreamBufferHandle_t xStreamBuffer)
+{
+    return xStreamBuffer->count;
+}
+
+BaseType_t xStreamBufferReset(StreamBufferHandle_t xStreamBuffer)
+{
+    xStreamBuffer->head = 0;
+    xStreamBuffer->count = 0;
+    return pdPASS;
+}
+
+/*
+ * Intertile
+ */
+#define HOST_INTERTILE_PORTS 16
+
+typedef struct host_msg {
+    struct host_msg *next;
+    size_t len;
+    uint8_t data[];
+} host_msg_t;
+
+struct host_intertile {
+    host_msg_t *head[HOST_INTERTILE_PORTS];
+    host_msg_t *tail[HOST_INTERTILE_PORTS];
+    host_msg_t *pending;
+    host_msg_t *sending;
+    uint8_t sending_port;
+    size_t sending_fill;
+};
+
+static struct host_intertile host_intertile_ctx;
+rtos_intertile_t *intertile_ctx = &host_intertile_ctx;
+
+void rtos_intertile_tx(rtos_intertile_t *ctx, uint8_t port, const void *msg, size_t len)
+{
+    configASSERT(port < HOST_INTERTILE_PORTS);
+    host_msg_t *m = malloc(sizeof(host_msg_t) + len);
+    configASSERT(m != NULL);
+
+    m->next = NULL;
+    m->len = len;
+    memcpy(m->data, msg, len);
+
+    if (ctx->tail[port] != NULL) {
+        ctx->tail[port]->next = m;
+    } else {
+        ctx->head[port] = m;
+    }
+    ctx->tail[port] = m;
+}
+
+void rtos_intertile_tx_len(rtos_intertile_t *ctx, uint8_t port, size_t len)
+{
+    configASSERT(port < HOST_INTERTILE_PORTS);
+    configASSERT(ctx->sending == NULL);
+
+    host_msg_t *m = malloc(sizeof(host_msg_t) + len);
+    configASSERT(m != NULL);
+
+    m->next = NULL;
+    m->len = len;
+    ctx->sending = m;
+    ctx->sending_port = port;
+    ctx->sending_fill = 0;
+}
+
+size_t rtos_intertile_tx_data(rtos_intertile_t *ctx, void *data, size_t len)
+{
+    host_msg_t *m = ctx->sending;
+    configASSERT(m != NULL);
+    configASSERT(ctx->sending_fill + len <= m->len);
+
+    memcpy(m->data + ctx->sending_fill, data, len);
+    ctx->sending_fill += len;
+
+    if (ctx->sending_fill == m->len) {
+        const uint8_t port = ctx->sending_port;
+        ctx->sending = NULL;
+        if (ctx->tail[port] != NULL) {
+            ctx->tail[port]->next = m;
+        } else {
+            ctx->head[port] = m;
+        }
+        ctx->tail[port] = m;
+    }
+    return len;
+}
+
+size_t rtos_intertile_rx_len(rtos_intertile_t *ctx, uint8_t port, unsigned timeout)
+{
+    (void) timeout;
+    configASSERT(port < HOST_INTERTILE_PORTS);
+    configASSERT(ctx->pending == NULL);
+
+    host_msg_t *m = ctx->head[port];
+    if (m == NULL) {
+        /* Nothing can arrive later on a single host thread */
+        return 0;
+    }
+
+    ctx->head[port] = m->next;
+    if (ctx->head[port] == NULL) {
+        ctx->tail[port] = NULL;
+    }
+    ctx->pending = m;
+    return m->len;
+}
+
+size_t rtos_intertile_rx_data(rtos_intertile_t *ctx, void *data, size_t len)
+{
+    host_msg_t *m = ctx->pending;
+    configASSERT(m != NULL);
+
+    if (len > m->len) {
+        len = m->len;
+    }
+    memcpy(data, m->data, len);
+    ctx->pending = NULL;
+    free(m);
+    return len;
+}
+
+/*
+ * Generic pipeline
+ */
+#define HOST_MAX_PIPELINES       4
+#define HOST_MAX_PIPELINE_STAGES 8
+
+typedef struct {
+    pipeline_input_t input;
+    pipeline_output_t output;
+    void *input_data;
+    void *output_data;
+    pipeline_stage_t stages[HOST_MAX_PIPELINE_STAGES];
+    int stage_count;
+} host_pipeline_t;
+
+static host_pipeline_t host_pipelines[HOST_MAX_PIPELINES];
+static int host_pipeline_cnt;
+
+void generic_pipeline_init(
+        const pipeline_input_t input,
+        const pipeline_output_t output,
+        void * const input_data,
+        void * const output_data,
+        const pipeline_stage_t * const stage_functions,
+        const size_t * const stage_stack_sizes,
+        const int pipeline_priority,
+        const int stage_count)
+{
+    (void) stage_stack_sizes;
+    (void) pipeline_priority;
+    configASSERT(host_pipeline_cnt < HOST_MAX_PIPELINES);
+    configASSERT(stage_count <= HOST_MAX_PIPELINE_STAGES);
+
+    host_pipeline_t *p = &host_pipelines[host_pipeline_cnt++];
+    p->input = input;
+    p->output = output;
+    p->input_data = input_data;
+    p->output_data = output_data;
+    p->stage_count = stage_count;
+    memcpy(p->stages, stage_functions, stage_count * sizeof(pipeline_stage_t));
+}
+
+int host_pipeline_count(void)
+{
+    return host_pipeline_cnt;
+}
+
+void host_pipeline_run_frame(int index)
+{
+    configASSERT(index < host_pipeline_cnt);
+    host_pipeline_t *p = &host_pipelines[index];
+
+    void *frame = p->input(p->input_data);
+    for (int i = 0; i < p->stage_count; i++) {
+        p->stages[i](frame);
+    }
+    if (p->output(frame, p->output_data) == AUDIO_PIPELINE_FREE_FRAME) {
+        vPortFree(frame);
+    }
+}
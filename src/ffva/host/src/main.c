@@ -0,0 +1,268 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Shim headers */
+#include "FreeRTOS.h"
+#include "generic_pipeline.h"
+
+/* App headers */
+#include "app_conf.h"
+#include "audio_pipeline.h"
+#include "configuration_servicer.h"
+#include "stage_profiler.h"
+#include "audio_pipeline_ctrl.h"
+#include "wav_io.h"
+
+/*
+ * Host runner for the reference audio pipelines.
+ *
+ * The tile 1 and tile 0 halves of the pipeline are built into one process.
+ * Their audio_pipeline_init() functions are renamed at compile time so that
+ * both can be linked. Each frame is pushed through the tile 1 pipeline, then
+ * the tile 0 pipeline, with the intertile hop handled by the shim.
+ *
+ * Input:  4 channel WAV, Ref L, Ref R, Mic 0, Mic 1
+ * Output: 6 channel WAV, in the audio_pipeline_output() channel order
+ *
+ * With --profile-csv, the per stage timings collected by the stage profiler
+ * are written out when the run completes, one row per stage.
+ *
+ * With --bypass, the given AP_BYPASS_* stages are skipped, as with the
+ * configuration servicer BYPASS_MASK command.
+ *
+ * With --aec-phases, the AEC runs with the given main and shadow filter
+ * lengths, as with the configuration servicer AEC_FILTER_PHASES command.
+ *
+ * With --mic-delay, the static delay is set in samples, as with the
+ * configuration servicer MIC_DELAY command.
+ */
+
+#define HOST_INPUT_CHANNELS  4
+#define HOST_OUTPUT_CHANNELS 6
+
+void audio_pipeline_init_tile0(void *input_app_data, void *output_app_data);
+void audio_pipeline_init_tile1(void *input_app_data, void *output_app_data);
+
+typedef struct {
+    wav_file_t in;
+    wav_file_t out;
+    uint32_t frames_to_write;
+} host_runner_t;
+
+void audio_pipeline_input(void *input_app_data,
+                        int32_t **input_audio_frames,
+                        size_t ch_count,
+                        size_t frame_count)
+{
+    host_runner_t *runner = input_app_data;
+    int32_t *dst = (int32_t *) input_audio_frames;
+    int32_t tmp[appconfAUDIO_PIPELINE_FRAME_ADVANCE][HOST_INPUT_CHANNELS];
+
+    xassert(ch_count == HOST_INPUT_CHANNELS);
+    xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+    /* The final partial frame is zero padded */
+    memset(tmp, 0x00, sizeof(tmp));
+    wav_read_frames(&runner->in, &tmp[0][0], frame_count);
+
+    for (int i = 0; i < frame_count; i++) {
+        for (int ch = 0; ch < ch_count; ch++) {
+            dst[ch * frame_count + i] = tmp[i][ch];
+        }
+    }
+}
+
+int audio_pipeline_output(void *output_app_data,
+                        int32_t **output_audio_frames,
+                        size_t ch_count,
+                        size_t frame_count)
+{
+    host_runner_t *runner = output_app_data;
+    const int32_t *src = (const int32_t *) output_audio_frames;
+    int32_t tmp[appconfAUDIO_PIPELINE_FRAME_ADVANCE][HOST_OUTPUT_CHANNELS];
+
+    xassert(ch_count == HOST_OUTPUT_CHANNELS);
+    xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+
+    for (int i = 0; i < frame_count; i++) {
+        for (int ch = 0; ch < ch_count; ch++) {
+            tmp[i][ch] = src[ch * frame_count + i];
+        }
+    }
+
+    if (frame_count > runner->frames_to_write) {
+        frame_count = runner->frames_to_write;
+    }
+    wav_write_frames(&runner->out, &tmp[0][0], frame_count);
+    runner->frames_to_write -= frame_count;
+
+    return AUDIO_PIPELINE_FREE_FRAME;
+}
+
+uint32_t audio_pipeline_output_channels(void *output_app_data)
+{
+    (void) output_app_data;
+
+    /* Every channel is written to the output WAV */
+    return (1 << HOST_OUTPUT_CHANNELS) - 1;
+}
+
+void audio_pipeline_input_status(void *input_app_data, audio_pipeline_input_status_t *status)
+{
+    (void) input_app_data;
+
+    /* The reference is read from the same WAV as the mics, so there is no clock offset */
+    memset(status, 0x00, sizeof(*status));
+}
+
+void configuration_push_vnr_value(int value)
+{
+    (void) value;
+}
+
+static int write_profile_csv(const char *path)
+{
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    fprintf(fp, "stage,frames,min_us,avg_us,max_us,p99_us");
+    for (int b = 0; b < STAGE_PROFILER_HIST_BINS; b++) {
+        fprintf(fp, ",lt_%lu_ticks", 1ul << b);
+    }
+    fprintf(fp, "\n");
+
+    for (int i = 0; i < stage_profiler_stage_count(); i++) {
+        stage_profiler_stats_t stats;
+        const uint32_t *hist = stage_profiler_get_histogram(i);
+
+        stage_profiler_get_stats(i, &stats);
+        fprintf(fp, "%s,%u,%.2f,%.2f,%.2f,%.2f",
+                stage_profiler_stage_name(i),
+                (unsigned) stats.frames,
+                (double) stats.min / STAGE_PROFILER_TICKS_PER_US,
+                (double) stats.avg / STAGE_PROFILER_TICKS_PER_US,
+                (double) stats.max / STAGE_PROFILER_TICKS_PER_US,
+                (double) stats.p99 / STAGE_PROFILER_TICKS_PER_US);
+        for (int b = 0; b < STAGE_PROFILER_HIST_BINS; b++) {
+            fprintf(fp, ",%u", (unsigned) hist[b]);
+        }
+        fprintf(fp, "\n");
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [--profile-csv <profile.csv>] [--bypass <mask>] [--aec-phases <main>,<shadow>] [--mic-delay <samples>] <input.wav> <output.wav>\n", name);
+    fprintf(stderr, "  input.wav   %d channel %d Hz WAV: Ref L, Ref R, Mic 0, Mic 1\n",
+            HOST_INPUT_CHANNELS, appconfAUDIO_PIPELINE_SAMPLE_RATE);
+    fprintf(stderr, "  output.wav  %d channel 32 bit WAV in audio_pipeline_output() order\n",
+            HOST_OUTPUT_CHANNELS);
+    fprintf(stderr, "  profile.csv per stage timing summary and log2 histogram\n");
+    fprintf(stderr, "  mask        stages to bypass: 0x1 delay, 0x2 AEC, 0x4 IC+VNR, 0x8 NS, 0x10 AGC\n");
+    fprintf(stderr, "  main,shadow AEC filter phases, checked against the pipeline's limits\n");
+    fprintf(stderr, "  samples     static delay, positive delays the mics, negative the reference\n");
+}
+
+int main(int argc, char **argv)
+{
+    static host_runner_t runner;
+    const char *profile_csv = NULL;
+    const char *aec_phases = NULL;
+    const char *mic_delay = NULL;
+    const char *name = argv[0];
+
+    while (argc > 2 && strncmp(argv[1], "--", 2) == 0) {
+        if (strcmp(argv[1], "--profile-csv") == 0) {
+            profile_csv = argv[2];
+        } else if (strcmp(argv[1], "--bypass") == 0) {
+            audio_pipeline_ctrl_set_bypass(strtoul(argv[2], NULL, 0));
+        } else if (strcmp(argv[1], "--aec-phases") == 0) {
+            aec_phases = argv[2];
+        } else if (strcmp(argv[1], "--mic-delay") == 0) {
+            mic_delay = argv[2];
+        } else {
+            usage(name);
+            return 1;
+        }
+        argc -= 2;
+        argv += 2;
+    }
+
+    if (argc != 3) {
+        usage(name);
+        return 1;
+    }
+
+    if (wav_open_read(&runner.in, argv[1]) != 0) {
+        fprintf(stderr, "Unable to read %s\n", argv[1]);
+        return 1;
+    }
+    if (runner.in.channels != HOST_INPUT_CHANNELS ||
+        runner.in.sample_rate != appconfAUDIO_PIPELINE_SAMPLE_RATE) {
+        fprintf(stderr, "%s must be %d channels at %d Hz, got %u channels at %u Hz\n",
+                argv[1], HOST_INPUT_CHANNELS, appconfAUDIO_PIPELINE_SAMPLE_RATE,
+                runner.in.channels, runner.in.sample_rate);
+        wav_close(&runner.in);
+        return 1;
+    }
+    if (wav_open_write(&runner.out, argv[2], HOST_OUTPUT_CHANNELS, appconfAUDIO_PIPELINE_SAMPLE_RATE) != 0) {
+        fprintf(stderr, "Unable to write %s\n", argv[2]);
+        wav_close(&runner.in);
+        return 1;
+    }
+    runner.frames_to_write = runner.in.frames_remaining;
+
+    /* Registration order sets the run order: tile 1 feeds tile 0 */
+    audio_pipeline_init_tile1(&runner, NULL);
+    audio_pipeline_init_tile0(NULL, &runner);
+    xassert(host_pipeline_count() == 2);
+
+    /* The pipeline's limits are only known once it is initialised */
+    if (aec_phases != NULL) {
+        unsigned main_phases, shadow_phases;
+
+        if (sscanf(aec_phases, "%u,%u", &main_phases, &shadow_phases) != 2 ||
+            main_phases > UINT8_MAX || shadow_phases > UINT8_MAX ||
+            audio_pipeline_ctrl_set_aec_phases(main_phases, shadow_phases) != 0) {
+            fprintf(stderr, "AEC filter phases %s are not supported by this pipeline\n", aec_phases);
+            wav_close(&runner.out);
+            wav_close(&runner.in);
+            return 1;
+        }
+    }
+    if (mic_delay != NULL && audio_pipeline_ctrl_set_mic_delay(strtol(mic_delay, NULL, 0)) != 0) {
+        fprintf(stderr, "Mic delay %s is not supported by this pipeline\n", mic_delay);
+        wav_close(&runner.out);
+        wav_close(&runner.in);
+        return 1;
+    }
+
+    while (runner.frames_to_write > 0) {
+        host_pipeline_run_frame(0);
+        host_pipeline_run_frame(1);
+    }
+
+    printf("Processed %u frames, heap high water %zu bytes\n",
+           (unsigned) runner.out.frames_written,
+           (size_t) (SIZE_MAX - xPortGetMinimumEverFreeHeapSize()));
+
+    wav_close(&runner.out);
+    wav_close(&runner.in);
+
+    if (profile_csv != NULL && write_profile_csv(profile_csv) != 0) {
+        fprintf(stderr, "Unable to write %s\n", profile_csv);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stdio.h>
+
+/* App headers */
+#include "pcm16.h"
+
+/*
+ * Host test for the 16 bit PCM kernel.
+ *
+ * Each check converts a channel longer than the kernel's chunk, so the
+ * scaled path runs more than one pass, and compares every sample with the
+ * value worked out here in 64 bits. Unity gain is src / 2^16 rounded to
+ * nearest; any other gain is rounded at src * gain / 2^30 and again on the
+ * shift down the last 2 bits, as the kernel does. The VPU saturates to
+ * +/-INT16_MAX. Halfway values are left out of the unity gain ramp, as the
+ * rounding of ties is up to lib_xcore_math.
+ *
+ * Prints the result of each check, and returns 1 if any failed.
+ */
+
+#define SAMPLES     (100)
+
+static int failures = 0;
+
+static void check(int ok, const char *what)
+{
+    printf("%s: %s\n", ok ? "pass" : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static int64_t saturate(int64_t value, int64_t max)
+{
+    if (value > max) value = max;
+    if (value < -max) value = -max;
+    return value;
+}
+
+static int16_t expected(int32_t sample, int32_t gain)
+{
+    int64_t value = sample;
+    int shr = 16;
+
+    if (gain != PCM16_GAIN_UNITY) {
+        value = ((int64_t) sample * gain + (1 << 29)) >> 30;
+        value = saturate(value, INT32_MAX);
+        shr = 2;
+    }
+    value = (value + (1 << (shr - 1))) >> shr;
+    return (int16_t) saturate(value, INT16_MAX);
+}
+
+static int converts(const int32_t *src, int32_t gain)
+{
+    int16_t dst[SAMPLES] __attribute__((aligned(4)));
+    int ok = 1;
+
+    pcm16_from_s32(dst, src, SAMPLES, gain);
+    for (int i = 0; i < SAMPLES; i++) {
+        if (dst[i] != expected(src[i], gain)) {
+            printf("  sample %d: %08x at gain %08x gave %d, not %d\n",
+                   i, (unsigned) src[i], (unsigned) gain, dst[i], expected(src[i], gain));
+            ok = 0;
+        }
+    }
+    return ok;
+}
+
+int main(void)
+{
+    int32_t ramp[SAMPLES] __attribute__((aligned(4)));
+    int32_t full_scale[SAMPLES] __attribute__((aligned(4)));
+    uint32_t seed = 1;
+
+    /* The low 12 bits are always 0x400, so no sample is a tie at unity gain */
+    for (int i = 0; i < SAMPLES; i++) {
+        seed = seed * 1664525 + 1013904223;
+        ramp[i] = (int32_t) ((seed & ~0x3FFFu) | 0x1001) >> 2;
+        full_scale[i] = (i & 1) ? INT32_MAX : INT32_MIN + 1;
+    }
+
+    int16_t top[SAMPLES] __attribute__((aligned(4)));
+    const int32_t rounds[4] = { 0x12347FFF, 0x12348001, -0x12347FFF, -0x12348001 };
+    pcm16_from_s32(top, rounds, 4, PCM16_GAIN_UNITY);
+    check(top[0] == 0x1234 && top[1] == 0x1235 && top[2] == -0x1234 && top[3] == -0x1235,
+          "unity gain rounds to the nearest of the top 16 bits");
+
+    check(converts(ramp, PCM16_GAIN_UNITY), "unity gain");
+    check(converts(ramp, PCM16_GAIN_UNITY / 2), "gain of 0.5");
+    check(converts(ramp, PCM16_GAIN_UNITY * 5), "gain of 5 saturates what it pushes past 16 bits");
+    check(converts(full_scale, PCM16_GAIN_UNITY), "full scale at unity gain");
+    check(converts(full_scale, PCM16_GAIN_UNITY * 4), "full scale at a gain of 4 saturates");
+
+    printf("%d checks failed\n", failures);
+    return failures ? 1 : 0;
+}
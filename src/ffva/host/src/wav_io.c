@@ -0,0 +1,171 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* App headers */
+#include "wav_io.h"
+
+#define WAV_HEADER_BYTES 44
+
+static uint32_t rd_u32(const uint8_t *p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static uint16_t rd_u16(const uint8_t *p)
+{
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static void wr_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static void wr_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v; p[1] = v >> 8;
+}
+
+int wav_open_read(wav_file_t *wav, const char *path)
+{
+    uint8_t hdr[12];
+    uint8_t chunk[8];
+    int have_fmt = 0;
+
+    memset(wav, 0, sizeof(wav_file_t));
+    wav->fp = fopen(path, "rb");
+    if (wav->fp == NULL) {
+        return -1;
+    }
+
+    if (fread(hdr, 1, sizeof(hdr), wav->fp) != sizeof(hdr) ||
+        memcmp(hdr, "RIFF", 4) != 0 || memcmp(hdr + 8, "WAVE", 4) != 0) {
+        goto fail;
+    }
+
+    /* Walk the chunks until the data chunk, skipping anything unknown */
+    while (fread(chunk, 1, sizeof(chunk), wav->fp) == sizeof(chunk)) {
+        uint32_t len = rd_u32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[16];
+            if (len < sizeof(fmt) || fread(fmt, 1, sizeof(fmt), wav->fp) != sizeof(fmt)) {
+                goto fail;
+            }
+            wav->channels = rd_u16(fmt + 2);
+            wav->sample_rate = rd_u32(fmt + 4);
+            wav->bits_per_sample = rd_u16(fmt + 14);
+            fseek(wav->fp, (len - sizeof(fmt)) + (len & 1), SEEK_CUR);
+            have_fmt = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt || wav->channels == 0) {
+                goto fail;
+            }
+            if (wav->bits_per_sample != 16 && wav->bits_per_sample != 24 && wav->bits_per_sample != 32) {
+                goto fail;
+            }
+            wav->frames_remaining = len / (wav->channels * (wav->bits_per_sample / 8));
+            return 0;
+        } else {
+            fseek(wav->fp, len + (len & 1), SEEK_CUR);
+        }
+    }
+
+fail:
+    fclose(wav->fp);
+    wav->fp = NULL;
+    return -1;
+}
+
+size_t wav_read_frames(wav_file_t *wav, int32_t *interleaved, size_t frame_count)
+{
+    const unsigned bytes = wav->bits_per_sample / 8;
+    uint8_t raw[4];
+    size_t n;
+
+    if (frame_count > wav->frames_remaining) {
+        frame_count = wav->frames_remaining;
+    }
+
+    for (n = 0; n < frame_count; n++) {
+        for (unsigned ch = 0; ch < wav->channels; ch++) {
+            if (fread(raw, 1, bytes, wav->fp) != bytes) {
+                wav->frames_remaining = 0;
+                return n;
+            }
+            uint32_t v = 0;
+            for (unsigned b = 0; b < bytes; b++) {
+                v |= (uint32_t) raw[b] << (8 * (b + 4 - bytes));
+            }
+            interleaved[n * wav->channels + ch] = (int32_t) v;
+        }
+    }
+    wav->frames_remaining -= n;
+    return n;
+}
+
+int wav_open_write(wav_file_t *wav, const char *path, unsigned channels, unsigned sample_rate)
+{
+    uint8_t hdr[WAV_HEADER_BYTES] = {0};
+
+    memset(wav, 0, sizeof(wav_file_t));
+    wav->fp = fopen(path, "wb");
+    if (wav->fp == NULL) {
+        return -1;
+    }
+    wav->channels = channels;
+    wav->sample_rate = sample_rate;
+    wav->bits_per_sample = 32;
+    wav->writing = 1;
+
+    /* Lengths are filled in by wav_close() */
+    fwrite(hdr, 1, sizeof(hdr), wav->fp);
+    return 0;
+}
+
+void wav_write_frames(wav_file_t *wav, const int32_t *interleaved, size_t frame_count)
+{
+    uint8_t raw[4];
+
+    for (size_t i = 0; i < frame_count * wav->channels; i++) {
+        wr_u32(raw, (uint32_t) interleaved[i]);
+        fwrite(raw, 1, sizeof(raw), wav->fp);
+    }
+    wav->frames_written += frame_count;
+}
+
+void wav_close(wav_file_t *wav)
+{
+    if (wav->fp == NULL) {
+        return;
+    }
+
+    if (wav->writing) {
+        uint8_t hdr[WAV_HEADER_BYTES];
+        const uint32_t block_align = wav->channels * 4;
+        const uint32_t data_bytes = wav->frames_written * block_align;
+
+        memcpy(hdr, "RIFF", 4);
+        wr_u32(hdr + 4, 36 + data_bytes);
+        memcpy(hdr + 8, "WAVEfmt ", 8);
+        wr_u32(hdr + 16, 16);
+        wr_u16(hdr + 20, 1);    /* PCM */
+        wr_u16(hdr + 22, wav->channels);
+        wr_u32(hdr + 24, wav->sample_rate);
+        wr_u32(hdr + 28, wav->sample_rate * block_align);
+        wr_u16(hdr + 32, block_align);
+        wr_u16(hdr + 34, 32);
+        memcpy(hdr + 36, "data", 4);
+        wr_u32(hdr + 40, data_bytes);
+
+        fseek(wav->fp, 0, SEEK_SET);
+        fwrite(hdr, 1, sizeof(hdr), wav->fp);
+    }
+    fclose(wav->fp);
+    wav->fp = NULL;
+}
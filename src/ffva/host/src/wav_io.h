@@ -0,0 +1,43 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef WAV_IO_H_
+#define WAV_IO_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef struct {
+    FILE *fp;
+    unsigned channels;
+    unsigned sample_rate;
+    unsigned bits_per_sample;
+    uint32_t frames_remaining;
+    uint32_t frames_written;
+    int writing;
+} wav_file_t;
+
+/*
+ * Opens a PCM WAV file for reading. 16, 24 and 32 bit integer samples are
+ * supported. Returns 0 on success.
+ */
+int wav_open_read(wav_file_t *wav, const char *path);
+
+/*
+ * Reads up to frame_count interleaved frames, left justified to 32 bits.
+ * Returns the number of frames read.
+ */
+size_t wav_read_frames(wav_file_t *wav, int32_t *interleaved, size_t frame_count);
+
+/*
+ * Creates a 32 bit PCM WAV file for writing. The header is finalised by
+ * wav_close(). Returns 0 on success.
+ */
+int wav_open_write(wav_file_t *wav, const char *path, unsigned channels, unsigned sample_rate);
+
+/* Writes frame_count interleaved 32 bit frames */
+void wav_write_frames(wav_file_t *wav, const int32_t *interleaved, size_t frame_count);
+
+void wav_close(wav_file_t *wav);
+
+#endif /* WAV_IO_H_ */
@@ -0,0 +1,230 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* STD headers */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Shim headers */
+#include <xcore/hwtimer.h>
+
+/* App headers */
+#include "app_conf.h"
+#include "feature_cache/feature_frontend.h"
+#include "ww_model_runner/ww_inference.h"
+#include "wav_io.h"
+
+/*
+ * Host benchmark for the wake word engine.
+ *
+ * The first channel of the WAV is fed through the same feature frontend
+ * as the feature cache and the same model as model_runner_manager(), a hop
+ * at a time, and the model is run every appconfWW_HOPS_PER_INFERENCE hops.
+ * Timings are in ticks of the 100 MHz reference clock, as on the device,
+ * and are for this host, not for an xcore. The arena high water mark is
+ * the same on both.
+ *
+ * Input: 16 kHz WAV, channel 0 is the ASR audio
+ *
+ * With --hops, the model runs every given number of hops instead.
+ *
+ * With --arena, the model is given an arena of the given bytes instead of
+ * appconfWW_TENSOR_ARENA_BYTES, to find the smallest that fits.
+ *
+ * With --scores-csv, the score of each model run is written out, one row
+ * per run.
+ */
+
+#define TICKS_PER_US    (100)
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+} ticks_stats_t;
+
+static void ticks_add(ticks_stats_t *stats, uint32_t ticks)
+{
+    if (stats->count == 0 || ticks < stats->min) stats->min = ticks;
+    if (ticks > stats->max) stats->max = ticks;
+    stats->total += ticks;
+    stats->count++;
+}
+
+static void ticks_print(const char *name, const ticks_stats_t *stats)
+{
+    uint32_t avg = stats->count ? (uint32_t) (stats->total / stats->count) : 0;
+
+    printf("%-10s %8u runs, ticks min %8u avg %8u max %8u, avg %.1f us\n",
+           name, (unsigned) stats->count,
+           (unsigned) stats->min, (unsigned) avg, (unsigned) stats->max,
+           (double) avg / TICKS_PER_US);
+}
+
+static uint8_t *read_model(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    /* As for the embedded model, the flatbuffer is read in place and must be 16 byte aligned */
+    uint8_t *model = size > 0 ? aligned_alloc(16, (size + 15) & ~15) : NULL;
+    if (model != NULL && fread(model, 1, size, fp) != (size_t) size) {
+        free(model);
+        model = NULL;
+    }
+
+    fclose(fp);
+    return model;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [--hops <n>] [--arena <bytes>] [--scores-csv <scores.csv>] <model.tflite> <input.wav>\n", name);
+    fprintf(stderr, "  model.tflite wake word model, as given to FFVA_WW_MODEL\n");
+    fprintf(stderr, "  input.wav    %d Hz WAV, channel 0 is used\n", appconfAUDIO_PIPELINE_SAMPLE_RATE);
+    fprintf(stderr, "  n            %d ms hops between model runs, default %d\n",
+            FEATURE_FRONTEND_HOP * 1000 / appconfAUDIO_PIPELINE_SAMPLE_RATE, appconfWW_HOPS_PER_INFERENCE);
+    fprintf(stderr, "  bytes        tensor arena size, default %d\n", appconfWW_TENSOR_ARENA_BYTES);
+    fprintf(stderr, "  scores.csv   time in seconds and score of each model run\n");
+}
+
+int main(int argc, char **argv)
+{
+    static feature_frontend_t frontend;
+    static feature_frame_t frame;
+    const char *scores_csv = NULL;
+    const char *name = argv[0];
+    int hops_per_inference = appconfWW_HOPS_PER_INFERENCE;
+    size_t arena_size = appconfWW_TENSOR_ARENA_BYTES;
+
+    while (argc > 2 && strncmp(argv[1], "--", 2) == 0) {
+        if (strcmp(argv[1], "--hops") == 0) {
+            hops_per_inference = strtol(argv[2], NULL, 0);
+        } else if (strcmp(argv[1], "--arena") == 0) {
+            arena_size = strtoul(argv[2], NULL, 0);
+        } else if (strcmp(argv[1], "--scores-csv") == 0) {
+            scores_csv = argv[2];
+        } else {
+            usage(name);
+            return 1;
+        }
+        argc -= 2;
+        argv += 2;
+    }
+
+    if (argc != 3 || hops_per_inference < 1) {
+        usage(name);
+        return 1;
+    }
+
+    uint8_t *model = read_model(argv[1]);
+    if (model == NULL) {
+        fprintf(stderr, "Unable to read %s\n", argv[1]);
+        return 1;
+    }
+
+    /* Allocated once, as model_runner_manager() does */
+    uint8_t *arena = malloc(arena_size);
+    if (arena == NULL || ww_inference_init(model, arena, arena_size) != 0) {
+        fprintf(stderr, "%s is not a supported wake word model, or does not fit in a %zu byte arena\n",
+                argv[1], arena_size);
+        free(arena);
+        free(model);
+        return 1;
+    }
+
+    wav_file_t in;
+    if (wav_open_read(&in, argv[2]) != 0) {
+        fprintf(stderr, "Unable to read %s\n", argv[2]);
+        free(arena);
+        free(model);
+        return 1;
+    }
+    if (in.sample_rate != appconfAUDIO_PIPELINE_SAMPLE_RATE) {
+        fprintf(stderr, "%s must be %d Hz, got %u Hz\n",
+                argv[2], appconfAUDIO_PIPELINE_SAMPLE_RATE, in.sample_rate);
+        wav_close(&in);
+        free(arena);
+        free(model);
+        return 1;
+    }
+
+    FILE *csv = NULL;
+    if (scores_csv != NULL) {
+        csv = fopen(scores_csv, "w");
+        if (csv == NULL) {
+            fprintf(stderr, "Unable to write %s\n", scores_csv);
+            wav_close(&in);
+            free(arena);
+            free(model);
+            return 1;
+        }
+        fprintf(csv, "time_s,score\n");
+    }
+
+    int32_t *frames = malloc(FEATURE_FRONTEND_HOP * in.channels * sizeof(int32_t));
+    ticks_stats_t frontend_stats = {0};
+    ticks_stats_t inference_stats = {0};
+    uint32_t hops = 0;
+    uint32_t detections = 0;
+    int holdoff = 0;
+
+    feature_frontend_init(&frontend);
+
+    while (wav_read_frames(&in, frames, FEATURE_FRONTEND_HOP) == FEATURE_FRONTEND_HOP) {
+        uint32_t start = get_reference_time();
+        feature_frontend_process(&frontend, frames, in.channels, &frame);
+        ww_inference_push(frame.mel);
+        ticks_add(&frontend_stats, get_reference_time() - start);
+
+        hops++;
+        if (holdoff > 0) {
+            holdoff--;
+        }
+        if (hops % hops_per_inference != 0) {
+            continue;
+        }
+
+        float score;
+        start = get_reference_time();
+        if (ww_inference_invoke(&score) != 0) {
+            fprintf(stderr, "Inference failed at hop %u\n", (unsigned) hops);
+            break;
+        }
+        ticks_add(&inference_stats, get_reference_time() - start);
+
+        double time_s = (double) hops * FEATURE_FRONTEND_HOP / appconfAUDIO_PIPELINE_SAMPLE_RATE;
+        if (csv != NULL) {
+            fprintf(csv, "%.2f,%.3f\n", time_s, score);
+        }
+        if (holdoff == 0 && score * 100 >= appconfWW_DETECT_THRESHOLD) {
+            printf("Wake word at %.2f s, score %d\n", time_s, (int) (score * 100));
+            holdoff = appconfWW_DETECT_HOLDOFF_HOPS;
+            detections++;
+        }
+    }
+
+    printf("Processed %u hops, %u wake words, model window %d frames\n",
+           (unsigned) hops, (unsigned) detections, ww_inference_frames());
+    ticks_print("frontend", &frontend_stats);
+    ticks_print("inference", &inference_stats);
+    printf("Tensor arena high water %zu of %zu bytes\n", ww_inference_arena_used(), arena_size);
+
+    if (csv != NULL) {
+        fclose(csv);
+    }
+    free(frames);
+    wav_close(&in);
+    free(arena);
+    free(model);
+    return 0;
+}
@@ -30,11 +30,15 @@
 #define appconfWW_SAMPLES_PORT         6
 #define appconfAUDIOPIPELINE_PORT      7
 #define appconfI2S_OUTPUT_SLAVE_PORT   8
+#define appconfAUDIOPIPELINE_CTRL_PORT 9
 
 /* Application tile specifiers */
 #include "platform/driver_instances.h"
 #define FS_TILE_NO              FLASH_TILE_NO
 #define AUDIO_PIPELINE_TILE_NO  MICARRAY_TILE_NO
+#define FEATURE_CACHE_TILE_NO   0   /* audio_pipeline_output() runs on tile 0 */
+#define WW_TILE_NO              FEATURE_CACHE_TILE_NO
+#define HOST_EVENTS_TILE_NO     I2C_CTRL_TILE_NO
 
 /* Audio Pipeline Configuration */
 #define appconfAUDIO_CLOCK_FREQUENCY            MIC_ARRAY_CONFIG_MCLK_FREQ
@@ -47,9 +51,14 @@
 /**
  * A positive delay will delay mics
  * A negative delay will delay ref
+ * It can be changed at runtime with the configuration servicer MIC_DELAY command.
  */
 #define appconfINPUT_SAMPLES_MIC_DELAY_MS        40
 
+/**
+ * Stages bypassed at boot. They can be changed at runtime with the
+ * configuration servicer BYPASS_MASK command.
+ */
 #ifdef appconfPIPELINE_BYPASS
 #define appconfAUDIO_PIPELINE_SKIP_STATIC_DELAY  1
 #define appconfAUDIO_PIPELINE_SKIP_AEC           1
@@ -94,6 +103,19 @@
 #define appconfWW_ENABLED          0
 #endif
 
+/*
+ * Features of the ASR output, made once per 10 ms hop in the output path
+ * and shared by every model that reads them, such as the wake word engine.
+ */
+#ifndef appconfFEATURE_CACHE_ENABLED
+#define appconfFEATURE_CACHE_ENABLED  appconfWW_ENABLED
+#endif
+
+/* Feature frames held for readers that fall behind */
+#ifndef appconfFEATURE_CACHE_FRAMES
+#define appconfFEATURE_CACHE_FRAMES   (8)
+#endif
+
 #ifndef appconfUSB_AUDIO_SAMPLE_RATE
 #define appconfUSB_AUDIO_SAMPLE_RATE appconfAUDIO_PIPELINE_SAMPLE_RATE
 #endif
@@ -106,6 +128,9 @@
 #define appconfI2S_AUDIO_SAMPLE_RATE appconfAUDIO_PIPELINE_SAMPLE_RATE
 #endif
 
+/* I2S frames per pipeline sample. At 3, the app converts each frame to and from the pipeline rate. */
+#define appconfI2S_SRC_FACTOR      (appconfI2S_AUDIO_SAMPLE_RATE / appconfAUDIO_PIPELINE_SAMPLE_RATE)
+
 #ifndef appconfEXTERNAL_MCLK
 #define appconfEXTERNAL_MCLK       0
 #endif
@@ -119,12 +144,33 @@
 #define appconfI2S_TDM_ENABLED     0
 #endif
 
+/*
+ * Slots per TDM frame: 6, 8 or 16. Each pair of slots is one I2S frame, so
+ * appconfI2S_AUDIO_SAMPLE_RATE must be appconfI2S_TDM_SLOTS / 2 times the
+ * pipeline rate. The channel in each slot is set with the configuration
+ * servicer TDM_SLOT_MAP command. The I2S reference input needs 6 slots,
+ * so more are only allowed in USB builds that take the reference from USB.
+ */
+#ifndef appconfI2S_TDM_SLOTS
+#define appconfI2S_TDM_SLOTS       6
+#endif
+
 #define appconfI2S_MODE_MASTER     0
 #define appconfI2S_MODE_SLAVE      1
 #ifndef appconfI2S_MODE
 #define appconfI2S_MODE            appconfI2S_MODE_MASTER
 #endif
 
+/*
+ * Passes the I2S reference through an asynchronous rate converter, for an
+ * I2S master that does not share a clock with the mics. Its state can be
+ * read with the configuration servicer REF_RATE command. lib_src only has
+ * an ASRC for 44.1 kHz and up, so this needs the 48 kHz I2S rate.
+ */
+#ifndef appconfI2S_REF_ASRC_ENABLED
+#define appconfI2S_REF_ASRC_ENABLED  ((appconfI2S_MODE == appconfI2S_MODE_SLAVE) && (appconfI2S_SRC_FACTOR == 3))
+#endif
+
 #define appconfAEC_REF_USB         0
 #define appconfAEC_REF_I2S         1
 #ifndef appconfAEC_REF_DEFAULT
@@ -153,7 +199,45 @@
 #include "app_conf_check.h"
 
 /* WW Config */
-#define appconfWW_FRAMES_PER_INFERENCE          (160)
+/* Feature hops between runs of the wake word model */
+#ifndef appconfWW_HOPS_PER_INFERENCE
+#define appconfWW_HOPS_PER_INFERENCE            (2)
+#endif
+
+/* Tensor arena for the wake word model, allocated once when the engine starts */
+#ifndef appconfWW_TENSOR_ARENA_BYTES
+#define appconfWW_TENSOR_ARENA_BYTES            (64 * 1024)
+#endif
+
+/* Score, 0-100, at or above which the wake word is detected */
+#ifndef appconfWW_DETECT_THRESHOLD
+#define appconfWW_DETECT_THRESHOLD              (80)
+#endif
+
+/* Feature hops after a detection before the next one is reported */
+#ifndef appconfWW_DETECT_HOLDOFF_HOPS
+#define appconfWW_DETECT_HOLDOFF_HOPS           (100)
+#endif
+
+/* Host Events Config */
+/*
+ * Voice, wake word and mute events are queued for the host, which reads
+ * them with the configuration servicer EVENTS command. The ESP IO 41 pin
+ * is high while any are queued. Off by default, as the mute switch is
+ * watched by the gpio_test task, which also prints each change.
+ */
+#ifndef appconfHOST_EVENTS_ENABLED
+#define appconfHOST_EVENTS_ENABLED              (0)
+#endif
+
+/* VNR, 0-100, at or above which voice is reported to start, and below which it is reported to end */
+#ifndef appconfHOST_EVENT_VNR_ON
+#define appconfHOST_EVENT_VNR_ON                (60)
+#endif
+
+#ifndef appconfHOST_EVENT_VNR_OFF
+#define appconfHOST_EVENT_VNR_OFF               (40)
+#endif
 
 /* I/O and interrupt cores for Tile 0 */
 /* Note, USB and SPI are mutually exclusive */
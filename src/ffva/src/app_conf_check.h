@@ -12,8 +12,28 @@
 #error Cannot use USB with an external mclk source
 #endif
 
-#if appconfI2S_TDM_ENABLED && appconfI2S_AUDIO_SAMPLE_RATE != 3*appconfAUDIO_PIPELINE_SAMPLE_RATE
-#error appconfI2S_AUDIO_SAMPLE_RATE must be 48000 to use I2S TDM
+#if !appconfI2S_TDM_ENABLED && appconfI2S_AUDIO_SAMPLE_RATE != appconfAUDIO_PIPELINE_SAMPLE_RATE && appconfI2S_AUDIO_SAMPLE_RATE != 3*appconfAUDIO_PIPELINE_SAMPLE_RATE
+#error appconfI2S_AUDIO_SAMPLE_RATE must be 16000 or 48000
+#endif
+
+#if appconfI2S_TDM_ENABLED && appconfI2S_TDM_SLOTS != 6 && appconfI2S_TDM_SLOTS != 8 && appconfI2S_TDM_SLOTS != 16
+#error appconfI2S_TDM_SLOTS must be 6, 8 or 16
+#endif
+
+#if appconfI2S_TDM_ENABLED && appconfI2S_AUDIO_SAMPLE_RATE != (appconfI2S_TDM_SLOTS / 2)*appconfAUDIO_PIPELINE_SAMPLE_RATE
+#error appconfI2S_AUDIO_SAMPLE_RATE must be appconfI2S_TDM_SLOTS / 2 times 16000 to use I2S TDM
+#endif
+
+#if appconfI2S_TDM_ENABLED && appconfI2S_TDM_SLOTS > 6 && (!appconfUSB_ENABLED || appconfAEC_REF_DEFAULT == appconfAEC_REF_I2S)
+#error The I2S reference needs appconfI2S_TDM_SLOTS of 6, there is no rate converter for more slots
+#endif
+
+#if appconfI2S_REF_ASRC_ENABLED && appconfI2S_AUDIO_SAMPLE_RATE != 3*appconfAUDIO_PIPELINE_SAMPLE_RATE
+#error appconfI2S_AUDIO_SAMPLE_RATE must be 48000 to use the I2S reference ASRC
+#endif
+
+#if appconfWW_ENABLED && !appconfFEATURE_CACHE_ENABLED
+#error The wake word engine reads its features from the feature cache
 #endif
 
 #if XK_VOICE_L71
@@ -1,6 +1,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "quadflashlib.h"
 
 #include "configuration_common.h"
@@ -14,6 +15,31 @@ static uint32_t data_partition_base_addr = 0;
 static uint32_t flash_size = 0;
 static uint32_t sector_size = 0;
 
+#define STORE_MAGIC             0x53474643  /* "CFGS" */
+#define STORE_ALIGN(n)          (((n) + 3) & ~3)
+#define STORE_ERASED_KEY        0xFF
+
+typedef struct {
+    uint32_t magic;
+    uint32_t seq;       /* One more than the sector written before it */
+} store_sector_header_t;
+
+typedef struct {
+    uint8_t key;
+    uint8_t reserved;
+    uint16_t length;
+    uint32_t crc;       /* Of key, length and value */
+} store_record_header_t;
+
+/* Flash address of the latest value of each key, 0 if never written */
+static uint32_t store_index_addr[CONFIGURATION_STORE_MAX_KEYS];
+static uint16_t store_index_length[CONFIGURATION_STORE_MAX_KEYS];
+
+static int store_active = -1;       /* Sector appended to, -1 until the first write */
+static uint32_t store_seq = 0;
+static uint32_t store_write_addr = 0;
+static int store_torn = 0;          /* The active sector ends in a record cut short by a reset */
+
 static uint32_t conriguration_check_flash()
 {
     if (sector_size == 0) return 1;
@@ -21,14 +47,228 @@ static uint32_t conriguration_check_flash()
     return 0;
 }
 
+static uint32_t store_sector_addr(int sector)
+{
+    /* The factory zone is the top sector */
+    return flash_size - (sector + 2) * sector_size;
+}
+
+static uint32_t store_crc(uint32_t crc, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return crc;
+}
+
+static uint32_t store_record_crc(const store_record_header_t *hdr, const uint8_t *value)
+{
+    uint32_t crc = store_crc(0xFFFFFFFF, &hdr->key, sizeof(hdr->key));
+    crc = store_crc(crc, (const uint8_t *) &hdr->length, sizeof(hdr->length));
+    return ~store_crc(crc, value, hdr->length);
+}
+
+/* Indexes the records of one sector, returns the address after the last good one */
+static uint32_t store_scan_sector(int sector, int *torn)
+{
+    const uint32_t end = store_sector_addr(sector) + sector_size;
+    uint32_t addr = store_sector_addr(sector) + sizeof(store_sector_header_t);
+    uint8_t value[CONFIGURATION_STORE_MAX_VALUE];
+
+    *torn = 0;
+    while (addr + sizeof(store_record_header_t) <= end) {
+        store_record_header_t hdr;
+        rtos_qspi_flash_read(qspi_flash_ctx, (uint8_t *) &hdr, addr, sizeof(hdr));
+
+        if (hdr.key == STORE_ERASED_KEY && hdr.length == 0xFFFF) {
+            break;
+        }
+        if (hdr.key >= CONFIGURATION_STORE_MAX_KEYS ||
+            hdr.length > CONFIGURATION_STORE_MAX_VALUE ||
+            addr + sizeof(hdr) + hdr.length > end) {
+            *torn = 1;
+            break;
+        }
+
+        rtos_qspi_flash_read(qspi_flash_ctx, value, addr + sizeof(hdr), hdr.length);
+        if (store_record_crc(&hdr, value) != hdr.crc) {
+            *torn = 1;
+            break;
+        }
+
+        store_index_addr[hdr.key] = addr + sizeof(hdr);
+        store_index_length[hdr.key] = hdr.length;
+        addr += sizeof(hdr) + STORE_ALIGN(hdr.length);
+    }
+    return addr;
+}
+
+static void store_init(void)
+{
+    store_sector_header_t hdr[CONFIGURATION_STORE_SECTORS];
+    uint32_t last_seq = 0;
+
+    memset(store_index_addr, 0, sizeof(store_index_addr));
+    store_active = -1;
+
+    for (int i = 0; i < CONFIGURATION_STORE_SECTORS; i++) {
+        rtos_qspi_flash_read(qspi_flash_ctx, (uint8_t *) &hdr[i], store_sector_addr(i), sizeof(hdr[i]));
+    }
+
+    /* Sectors are replayed oldest first, so each key ends up at its latest value */
+    for (;;) {
+        int next = -1;
+        for (int i = 0; i < CONFIGURATION_STORE_SECTORS; i++) {
+            if (hdr[i].magic == STORE_MAGIC &&
+                (store_active < 0 || hdr[i].seq > last_seq) &&
+                (next < 0 || hdr[i].seq < hdr[next].seq)) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+
+        store_active = next;
+        last_seq = hdr[next].seq;
+        store_write_addr = store_scan_sector(next, &store_torn);
+    }
+    store_seq = last_seq;
+
+    rtos_printf("configuration store: sector %d, %u bytes free\n", store_active,
+                store_active < 0 ? sector_size : store_sector_addr(store_active) + sector_size - store_write_addr);
+}
+
+/*
+ * Starts the next sector with the latest value of each key. The values are
+ * read into RAM first, as they may be in the sector about to be erased.
+ */
+static uint32_t store_compact(void)
+{
+    const int next = (store_active + 1) % CONFIGURATION_STORE_SECTORS;
+    const uint32_t base = store_sector_addr(next);
+    uint8_t *tmp_buf = rtos_osal_malloc(sizeof(uint8_t) * sector_size);
+    uint32_t new_addr[CONFIGURATION_STORE_MAX_KEYS];
+    uint32_t used = sizeof(store_sector_header_t);
+
+    if (tmp_buf == NULL) return 1;
+    memset(tmp_buf, 0xFF, sector_size);
+
+    const store_sector_header_t sector_hdr = { .magic = STORE_MAGIC, .seq = store_seq + 1 };
+    memcpy(tmp_buf, &sector_hdr, sizeof(sector_hdr));
+
+    for (int key = 0; key < CONFIGURATION_STORE_MAX_KEYS; key++) {
+        new_addr[key] = 0;
+        if (store_index_addr[key] == 0) {
+            continue;
+        }
+
+        store_record_header_t hdr = { .key = key, .reserved = 0xFF, .length = store_index_length[key] };
+        uint8_t *value = tmp_buf + used + sizeof(hdr);
+        rtos_qspi_flash_read(qspi_flash_ctx, value, store_index_addr[key], hdr.length);
+        hdr.crc = store_record_crc(&hdr, value);
+        memcpy(tmp_buf + used, &hdr, sizeof(hdr));
+
+        new_addr[key] = base + used + sizeof(hdr);
+        used += sizeof(hdr) + STORE_ALIGN(hdr.length);
+    }
+
+    rtos_qspi_flash_erase(qspi_flash_ctx, base, sector_size);
+    rtos_qspi_flash_write(qspi_flash_ctx, tmp_buf, base, used);
+    rtos_osal_free(tmp_buf);
+
+    memcpy(store_index_addr, new_addr, sizeof(store_index_addr));
+    store_active = next;
+    store_seq++;
+    store_write_addr = base + used;
+    store_torn = 0;
+    return 0;
+}
+
 uint32_t configuration_init()
 {
     data_partition_base_addr = rtos_dfu_image_get_data_partition_addr(dfu_image_ctx);
     flash_size = rtos_qspi_flash_size_get(qspi_flash_ctx);
     sector_size = rtos_qspi_flash_sector_size_get(qspi_flash_ctx);
+    if (conriguration_check_flash() != 0) return 1; // flash config not right
+    if (store_sector_addr(CONFIGURATION_STORE_SECTORS - 1) < data_partition_base_addr) return 1; // no room for the store
+
+    rtos_qspi_flash_lock(qspi_flash_ctx);
+    store_init();
+    rtos_qspi_flash_unlock(qspi_flash_ctx);
     return 0;
 }
 
+uint32_t configuration_store_write(uint8_t key,
+                                   uint8_t const *data,
+                                   uint16_t length)
+{
+    uint32_t ret = 0;
+    uint8_t record[sizeof(store_record_header_t) + STORE_ALIGN(CONFIGURATION_STORE_MAX_VALUE)];
+    store_record_header_t hdr = { .key = key, .reserved = 0xFF, .length = length };
+    const uint32_t record_size = sizeof(hdr) + STORE_ALIGN(length);
+
+    if (conriguration_check_flash() != 0) return 1; // flash config not right
+    if (key >= CONFIGURATION_STORE_MAX_KEYS) return 4; // unknown key
+    if (length > CONFIGURATION_STORE_MAX_VALUE) return 3; // write length too long
+
+    hdr.crc = store_record_crc(&hdr, data);
+    memcpy(record, &hdr, sizeof(hdr));
+    memset(record + sizeof(hdr), 0xFF, STORE_ALIGN(length));
+    memcpy(record + sizeof(hdr), data, length);
+
+    rtos_qspi_flash_lock(qspi_flash_ctx);
+    {
+        /* Unchanged values are not written again */
+        if (store_index_addr[key] != 0 && store_index_length[key] == length) {
+            uint8_t cur[CONFIGURATION_STORE_MAX_VALUE];
+            rtos_qspi_flash_read(qspi_flash_ctx, cur, store_index_addr[key], length);
+            if (memcmp(cur, data, length) == 0) {
+                rtos_qspi_flash_unlock(qspi_flash_ctx);
+                return 0;
+            }
+        }
+
+        if (store_active < 0 || store_torn ||
+            store_write_addr + record_size > store_sector_addr(store_active) + sector_size) {
+            ret = store_compact();
+        }
+
+        if (ret == 0) {
+            rtos_qspi_flash_write(qspi_flash_ctx, record, store_write_addr, record_size);
+            store_index_addr[key] = store_write_addr + sizeof(hdr);
+            store_index_length[key] = length;
+            store_write_addr += record_size;
+        }
+    }
+    rtos_qspi_flash_unlock(qspi_flash_ctx);
+
+    return ret;
+}
+
+uint16_t configuration_store_read(uint8_t key,
+                                  uint8_t *data,
+                                  uint16_t length)
+{
+    if (key >= CONFIGURATION_STORE_MAX_KEYS) return 0;
+
+    rtos_qspi_flash_lock(qspi_flash_ctx);
+    if (store_index_addr[key] == 0) {
+        length = 0;
+    } else {
+        if (length > store_index_length[key]) {
+            length = store_index_length[key];
+        }
+        rtos_qspi_flash_read(qspi_flash_ctx, data, store_index_addr[key], length);
+    }
+    rtos_qspi_flash_unlock(qspi_flash_ctx);
+
+    return length;
+}
+
 uint32_t configuration_write_to_flash(uint8_t zone,
                                         uint8_t const *data,
                                         uint16_t length)
@@ -47,32 +287,7 @@ uint32_t configuration_write_to_flash(uint8_t zone,
 
         case CONFIGURATION_CUSTOMER_ZONE:
         {
-            if (length > sector_size) return 3; // write length too long
-            rtos_printf("write %d at 0x%x\n", length, cur_addr);
-
-            uint8_t *tmp_buf = rtos_osal_malloc( sizeof(uint8_t) * sector_size);
-            rtos_printf("alloc heap at 0x%x\n", tmp_buf);
-            rtos_qspi_flash_lock(qspi_flash_ctx);
-            {
-                rtos_qspi_flash_read(
-                        qspi_flash_ctx,
-                        tmp_buf,
-                        cur_addr,
-                        sector_size);
-                memcpy(tmp_buf, data, length);
-                rtos_qspi_flash_erase(
-                        qspi_flash_ctx,
-                        cur_addr,
-                        sector_size);
-                rtos_qspi_flash_write(
-                        qspi_flash_ctx,
-                        (uint8_t *) tmp_buf,
-                        cur_addr,
-                        sector_size);
-            }
-            rtos_qspi_flash_unlock(qspi_flash_ctx);
-            rtos_osal_free(tmp_buf);
-            return 0;
+            return configuration_store_write(CONFIGURATION_STORE_KEY_CUSTOMER_ZONE, data, length);
         }
         break;
 
@@ -107,6 +322,12 @@ uint16_t configuration_read_from_flash(uint8_t zone,
 {
     uint32_t cur_addr;
     if (conriguration_check_flash() != 0) return 1; // flash config not right
+    if (zone == CONFIGURATION_CUSTOMER_ZONE) {
+        if (length > CONFIGURATION_STORE_MAX_VALUE) return 3; // read length too long
+        memset(data, 0xFF, length); // as an erased zone reads
+        configuration_store_read(CONFIGURATION_STORE_KEY_CUSTOMER_ZONE, data, length);
+        return 0;
+    }
     cur_addr = flash_size - (zone + 1) * sector_size;
     if (cur_addr < data_partition_base_addr) return 1; // flash config not right
 
@@ -7,10 +7,43 @@
 #define CONFIGURATION_FACTORY_ZONE      0
 #define CONFIGURATION_CUSTOMER_ZONE     1
 
+/*
+ * Customer settings are kept in a log structured key/value store in the
+ * sectors below the factory zone, at the top of the data partition. Each
+ * write appends a record with a CRC to the active sector. When it is full,
+ * the latest value of each key is copied to the next sector, so erases
+ * rotate over all of the store's sectors. The flash address of the latest
+ * value of each key is indexed in SRAM by configuration_init().
+ *
+ * The latest values of all keys must fit in one sector:
+ * CONFIGURATION_STORE_MAX_KEYS * (8 + CONFIGURATION_STORE_MAX_VALUE) + 8
+ * bytes, which is 2312 of a 4096 byte sector.
+ */
+#ifndef CONFIGURATION_STORE_SECTORS
+#define CONFIGURATION_STORE_SECTORS     2
+#endif
+
+#define CONFIGURATION_STORE_MAX_KEYS    32
+#define CONFIGURATION_STORE_MAX_VALUE   64
+
+/* Key holding the customer zone */
+#define CONFIGURATION_STORE_KEY_CUSTOMER_ZONE   0
+
+/* Key holding the customer's configuration_tunables_t */
+#define CONFIGURATION_STORE_KEY_TUNABLES        1
+
 uint32_t configuration_init();
 
 uint32_t configuration_flush();
 
+/*
+ * The factory zone is read only and can be read up to a sector. The
+ * customer zone is kept in the store under
+ * CONFIGURATION_STORE_KEY_CUSTOMER_ZONE, so it holds at most
+ * CONFIGURATION_STORE_MAX_VALUE bytes, and longer reads and writes return 3.
+ * A write replaces the whole zone, and bytes past its length read as 0xFF,
+ * as erased flash does.
+ */
 uint32_t configuration_write_to_flash(uint8_t zone,
                                    uint8_t const *data,
                                    uint16_t length);
@@ -19,4 +52,14 @@ uint16_t configuration_read_from_flash(uint8_t zone,
                                     uint8_t *data,
                                     uint16_t length);
 
+/* Returns 0 once the record is written */
+uint32_t configuration_store_write(uint8_t key,
+                                   uint8_t const *data,
+                                   uint16_t length);
+
+/* Returns the length of the value read, or 0 if the key has never been written */
+uint16_t configuration_store_read(uint8_t key,
+                                  uint8_t *data,
+                                  uint16_t length);
+
 #endif
\ No newline at end of file
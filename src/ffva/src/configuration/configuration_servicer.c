@@ -13,12 +13,366 @@
 #include "servicer.h"
 #include "configuration_servicer.h"
 #include "configuration_common.h"
+#include "stage_profiler.h"
+#include "pipeline_telemetry.h"
+#include "audio_pipeline_ctrl.h"
+#include "host_events/host_events.h"
 
 static uint8_t vnr_value = 0;
+static uint8_t ww_score = 0;
+static uint8_t ww_detections = 0;
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+static int voice_active = 0;
+#endif
 
 static enum e_pipeline_processing_stages channel_0_stage = PIPELINE_STAGE_AGC;
 static enum e_pipeline_processing_stages channel_1_stage = PIPELINE_STAGE_AEC;
 
+/* Raw mics and references with bit 0 clear, then processed audio with it set */
+static uint8_t tdm_slot_map[CONFIGURATION_SERVICER_TDM_SLOTS] = {
+    4, 5, 2, 3,
+    0 | CONFIGURATION_TDM_SLOT_TAG,
+    1 | CONFIGURATION_TDM_SLOT_TAG,
+    CONFIGURATION_TDM_SLOT_SILENT, CONFIGURATION_TDM_SLOT_SILENT,
+    CONFIGURATION_TDM_SLOT_SILENT, CONFIGURATION_TDM_SLOT_SILENT,
+    CONFIGURATION_TDM_SLOT_SILENT, CONFIGURATION_TDM_SLOT_SILENT,
+    CONFIGURATION_TDM_SLOT_SILENT, CONFIGURATION_TDM_SLOT_SILENT,
+    CONFIGURATION_TDM_SLOT_SILENT, CONFIGURATION_TDM_SLOT_SILENT,
+};
+
+/* Number of the next pipeline telemetry record TELEMETRY reads */
+static uint32_t telemetry_seq = 0;
+
+/* Commands read by BATCH_READ */
+static uint8_t batch_read_cmds[CONFIGURATION_SERVICER_BATCH_MAX_CMDS];
+static uint8_t batch_read_count = 0;
+
+static int tdm_slot_map_valid(const uint8_t *map)
+{
+    for (int i = 0; i < CONFIGURATION_SERVICER_TDM_SLOTS; i++) {
+        uint8_t src = map[i] & ~CONFIGURATION_TDM_SLOT_TAG;
+        if (src >= CONFIGURATION_TDM_SLOT_SOURCES && src != CONFIGURATION_TDM_SLOT_SILENT) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static uint8_t *put_stage_profile(uint8_t *p, const stage_profiler_stats_t *stats)
+{
+    const uint32_t vals[CONFIGURATION_SERVICER_STAGE_PROFILE_VALS] = {
+        stats->min, stats->avg, stats->max, stats->p99
+    };
+
+    for (int i = 0; i < CONFIGURATION_SERVICER_STAGE_PROFILE_VALS; i++) {
+        uint32_t us = vals[i] / STAGE_PROFILER_TICKS_PER_US;
+        if (us > UINT16_MAX) us = UINT16_MAX;
+        *p++ = us & 0xFF;
+        *p++ = us >> 8;
+    }
+    return p;
+}
+
+static void read_ref_rate(uint8_t *payload)
+{
+    audio_pipeline_input_status_t status;
+    audio_pipeline_ctrl_get_input_status(&status);
+
+    const uint32_t vals[CONFIGURATION_SERVICER_REF_RATE_VALS] = {
+        (uint32_t) status.ref_rate_ppb, status.ref_fill, status.ref_xruns
+    };
+
+    for (int i = 0; i < CONFIGURATION_SERVICER_REF_RATE_VALS; i++) {
+        for (int b = 0; b < sizeof(int32_t); b++) {
+            *payload++ = (vals[i] >> (8 * b)) & 0xFF;
+        }
+    }
+}
+
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+static void read_events(uint8_t *payload)
+{
+    host_event_t events[CONFIGURATION_SERVICER_EVENTS_MAX];
+    const size_t count = host_events_read(events, CONFIGURATION_SERVICER_EVENTS_MAX, &payload[1]);
+
+    payload[0] = count;
+    payload += 2;
+    for (size_t i = 0; i < count; i++) {
+        *payload++ = events[i].type;
+        *payload++ = events[i].value;
+        *payload++ = events[i].time_ms & 0xFF;
+        *payload++ = events[i].time_ms >> 8;
+    }
+}
+#endif
+
+static void read_telemetry(uint8_t *payload)
+{
+    pipeline_telemetry_t records[CONFIGURATION_SERVICER_TELEMETRY_MAX];
+    uint32_t first_seq;
+    const size_t count = pipeline_telemetry_read(telemetry_seq, records, CONFIGURATION_SERVICER_TELEMETRY_MAX, &first_seq);
+
+    telemetry_seq = first_seq + count;
+    for (int b = 0; b < sizeof(uint32_t); b++) {
+        *payload++ = (first_seq >> (8 * b)) & 0xFF;
+    }
+    *payload++ = count;
+    for (size_t i = 0; i < count; i++) {
+        *payload++ = records[i].vnr_in;
+        *payload++ = records[i].vnr_out;
+        *payload++ = (uint8_t) records[i].ref_energy_db;
+        *payload++ = records[i].aec_corr;
+        *payload++ = (uint16_t) records[i].agc_gain_cdb & 0xFF;
+        *payload++ = (uint16_t) records[i].agc_gain_cdb >> 8;
+        *payload++ = records[i].flags;
+        *payload++ = 0;
+    }
+}
+
+static void read_stage_profile(uint8_t *payload)
+{
+    stage_profiler_snapshot_t remote;
+    stage_profiler_stats_t stats;
+    int reported = 0;
+
+    stage_profiler_get_remote(&remote);
+    for (int i = 0; i < remote.stage_count && reported < CONFIGURATION_SERVICER_STAGE_PROFILE_STAGES; i++, reported++) {
+        payload = put_stage_profile(payload, &remote.stats[i]);
+    }
+
+    for (int i = 0; i < stage_profiler_stage_count() && reported < CONFIGURATION_SERVICER_STAGE_PROFILE_STAGES; i++, reported++) {
+        stage_profiler_get_stats(i, &stats);
+        payload = put_stage_profile(payload, &stats);
+    }
+}
+
+static void get_tunables(configuration_tunables_t *t)
+{
+    int16_t delay = audio_pipeline_ctrl_get_mic_delay();
+
+    memset(t, 0, sizeof(*t));
+    t->magic[0] = CONFIGURATION_TUNABLES_MAGIC & 0xFF;
+    t->magic[1] = CONFIGURATION_TUNABLES_MAGIC >> 8;
+    t->version = CONFIGURATION_TUNABLES_VERSION;
+    t->fields = CONFIGURATION_TUNABLE_ALL;
+    t->channel_0_stage = channel_0_stage;
+    t->channel_1_stage = channel_1_stage;
+    t->bypass_mask = audio_pipeline_ctrl_get_bypass();
+    audio_pipeline_ctrl_get_aec_phases(&t->aec_main_phases, &t->aec_shadow_phases);
+    t->mic_delay[0] = delay & 0xFF;
+    t->mic_delay[1] = (delay >> 8) & 0xFF;
+    memcpy(t->tdm_slot_map, tdm_slot_map, sizeof(tdm_slot_map));
+
+    /* Pipelines without an AEC report 0 phases, which no pipeline accepts */
+    if (t->aec_main_phases == 0) {
+        t->fields &= ~CONFIGURATION_TUNABLE_AEC_PHASES;
+    }
+}
+
+/* Returns the fields of the tunables saved in zone, 0 if there are none */
+static uint8_t read_tunables(uint8_t zone, configuration_tunables_t *t)
+{
+    if (zone == CONFIGURATION_FACTORY_ZONE) {
+        if (configuration_read_from_flash(zone, (uint8_t *) t, sizeof(*t)) != 0) {
+            return 0;
+        }
+    } else if (configuration_store_read(CONFIGURATION_STORE_KEY_TUNABLES, (uint8_t *) t, sizeof(*t)) != sizeof(*t)) {
+        return 0;
+    }
+
+    if ((t->magic[0] | (t->magic[1] << 8)) != CONFIGURATION_TUNABLES_MAGIC ||
+        t->version != CONFIGURATION_TUNABLES_VERSION) {
+        return 0;
+    }
+    return t->fields & CONFIGURATION_TUNABLE_ALL;
+}
+
+/*
+ * Applies tunables as the values the pipeline starts with. The pipeline
+ * checks the AEC phases and mic delay when it registers its limits, and
+ * values it rejects are left as they were.
+ */
+static void apply_tunables(const configuration_tunables_t *t, uint8_t fields)
+{
+    if (fields & CONFIGURATION_TUNABLE_CHANNEL_STAGES) {
+        if (t->channel_0_stage <= PIPELINE_STAGE_AGC && t->channel_1_stage <= PIPELINE_STAGE_AGC) {
+            channel_0_stage = t->channel_0_stage;
+            channel_1_stage = t->channel_1_stage;
+        } else {
+            rtos_printf("saved channel stages %u, %u not valid\n", t->channel_0_stage, t->channel_1_stage);
+        }
+    }
+    if (fields & CONFIGURATION_TUNABLE_BYPASS_MASK) {
+        audio_pipeline_ctrl_set_bypass(t->bypass_mask);
+    }
+    if (fields & CONFIGURATION_TUNABLE_AEC_PHASES) {
+        audio_pipeline_ctrl_set_default_aec_phases(t->aec_main_phases, t->aec_shadow_phases);
+    }
+    if (fields & CONFIGURATION_TUNABLE_MIC_DELAY) {
+        int16_t delay = (int16_t)(t->mic_delay[0] | (t->mic_delay[1] << 8));
+        audio_pipeline_ctrl_set_default_mic_delay(delay);
+    }
+    if (fields & CONFIGURATION_TUNABLE_TDM_SLOT_MAP) {
+        if (tdm_slot_map_valid(t->tdm_slot_map)) {
+            memcpy(tdm_slot_map, t->tdm_slot_map, sizeof(tdm_slot_map));
+        } else {
+            rtos_printf("saved TDM slot map not valid\n");
+        }
+    }
+}
+
+static uint32_t save_tunables(uint8_t action)
+{
+    configuration_tunables_t t = {0};
+
+    switch (action)
+    {
+        case CONFIGURATION_SAVE_CLEAR:
+            /* A zero length value reads back as none saved */
+            return configuration_store_write(CONFIGURATION_STORE_KEY_TUNABLES, (uint8_t *) &t, 0);
+        case CONFIGURATION_SAVE_CURRENT:
+            get_tunables(&t);
+            return configuration_store_write(CONFIGURATION_STORE_KEY_TUNABLES, (uint8_t *) &t, sizeof(t));
+        default:
+            return 1;
+    }
+}
+
+static const control_cmd_info_t *find_cmd_info(uint8_t cmd_id)
+{
+    for (int i = 0; i < NUM_CONFIGURATION_SERVICER_RESID_CMDS; i++) {
+        if (configuration_servicer_resid_cmd_map[i].cmd_id == cmd_id) {
+            return &configuration_servicer_resid_cmd_map[i];
+        }
+    }
+    return NULL;
+}
+
+static size_t cmd_value_len(const control_cmd_info_t *info)
+{
+    return info->num_vals * info->bytes_per_val;
+}
+
+static control_ret_t batch_select(const uint8_t *payload, size_t payload_len)
+{
+    size_t total = 0;
+
+    if (payload_len == 0 || payload_len > CONFIGURATION_SERVICER_BATCH_MAX_CMDS) {
+        return CONTROL_ERROR;
+    }
+
+    for (size_t i = 0; i < payload_len; i++) {
+        const control_cmd_info_t *info = find_cmd_info(payload[i]);
+        /* Reading events or telemetry removes them, so they cannot be read again */
+        if (info == NULL || info->cmd_rw_type == CMD_WRITE_ONLY ||
+            payload[i] == CONFIGURATION_SERVICER_RESID_BATCH_READ ||
+            payload[i] == CONFIGURATION_SERVICER_RESID_EVENTS ||
+            payload[i] == CONFIGURATION_SERVICER_RESID_TELEMETRY) {
+            return CONTROL_ERROR;
+        }
+        total += cmd_value_len(info);
+    }
+    if (total > CONFIGURATION_SERVICER_BATCH_MAX_BYTES) {
+        return CONTROL_ERROR;
+    }
+
+    memcpy(batch_read_cmds, payload, payload_len);
+    batch_read_count = payload_len;
+    return CONTROL_SUCCESS;
+}
+
+static control_ret_t batch_read(uint8_t *payload, size_t payload_len)
+{
+    /* Status byte, then the value */
+    uint8_t value[1 + CONFIGURATION_SERVICER_BATCH_MAX_BYTES];
+    size_t total = 0;
+
+    for (int i = 0; i < batch_read_count; i++) {
+        total += cmd_value_len(find_cmd_info(batch_read_cmds[i]));
+    }
+    if (total > payload_len) {
+        return CONTROL_ERROR;
+    }
+
+    for (int i = 0; i < batch_read_count; i++) {
+        const size_t len = cmd_value_len(find_cmd_info(batch_read_cmds[i]));
+
+        const control_ret_t ret = configuration_servicer_read_cmd(NULL, batch_read_cmds[i], value, 1 + len);
+        if (ret != CONTROL_SUCCESS) {
+            return ret;
+        }
+        memcpy(payload, &value[1], len);
+        payload += len;
+    }
+    return CONTROL_SUCCESS;
+}
+
+static control_ret_t batch_write(const uint8_t *payload, size_t payload_len)
+{
+    audio_pipeline_ctrl_t settings;
+    uint8_t stage_0 = channel_0_stage;
+    uint8_t stage_1 = channel_1_stage;
+    uint8_t slot_map[CONFIGURATION_SERVICER_TDM_SLOTS];
+
+    audio_pipeline_ctrl_get_settings(&settings);
+    memcpy(slot_map, tdm_slot_map, sizeof(slot_map));
+
+    /* Every entry is checked and staged before any is applied */
+    for (size_t offset = 0; offset < payload_len; ) {
+        const uint8_t cmd_id = payload[offset];
+        const control_cmd_info_t *info = find_cmd_info(cmd_id);
+        const uint8_t *value = &payload[offset + 1];
+
+        if (info == NULL || offset + 1 + cmd_value_len(info) > payload_len) {
+            return CONTROL_ERROR;
+        }
+
+        switch (cmd_id)
+        {
+            case CONFIGURATION_SERVICER_RESID_CHANNEL_0_STAGE:
+            case CONFIGURATION_SERVICER_RESID_CHANNEL_1_STAGE:
+                if (value[0] > PIPELINE_STAGE_AGC) {
+                    return CONTROL_ERROR;
+                }
+                if (cmd_id == CONFIGURATION_SERVICER_RESID_CHANNEL_0_STAGE) {
+                    stage_0 = value[0];
+                } else {
+                    stage_1 = value[0];
+                }
+                break;
+            case CONFIGURATION_SERVICER_RESID_BYPASS_MASK:
+                settings.bypass_mask = value[0];
+                break;
+            case CONFIGURATION_SERVICER_RESID_AEC_FILTER_PHASES:
+                settings.aec_main_phases = value[0];
+                settings.aec_shadow_phases = value[1];
+                break;
+            case CONFIGURATION_SERVICER_RESID_MIC_DELAY:
+                settings.mic_delay_samples = (int16_t)(value[0] | (value[1] << 8));
+                break;
+            case CONFIGURATION_SERVICER_RESID_TDM_SLOT_MAP:
+                if (!tdm_slot_map_valid(value)) {
+                    return CONTROL_ERROR;
+                }
+                memcpy(slot_map, value, sizeof(slot_map));
+                break;
+            default:
+                return CONTROL_ERROR;
+        }
+        offset += 1 + cmd_value_len(info);
+    }
+
+    /* The pipeline settings reach tile 1 in the same frame, and only the
+     * pipeline can reject them, so nothing else is applied if it does */
+    if (audio_pipeline_ctrl_set_settings(&settings) != 0) {
+        return CONTROL_ERROR;
+    }
+    channel_0_stage = stage_0;
+    channel_1_stage = stage_1;
+    memcpy(tdm_slot_map, slot_map, sizeof(tdm_slot_map));
+    return CONTROL_SUCCESS;
+}
+
 void configuration_servicer_init(servicer_t *servicer)
 {
     // Servicer resource info
@@ -72,6 +426,17 @@ control_ret_t configuration_servicer_read_cmd(control_resource_info_t *res_info,
     float value_f = 0.0;
     uint8_t gpio_val;
 
+    /* Commands are not checked by the servicer before they reach here, and
+     * some reads remove what they return, so a short read must fail first */
+    const control_cmd_info_t *info = find_cmd_info(cmd_id);
+    if (payload_len < 1) {
+        return CONTROL_DATA_LENGTH_ERROR;
+    }
+    if (info != NULL && cmd_id != CONFIGURATION_SERVICER_RESID_BATCH_READ &&
+        payload_len < 1 + cmd_value_len(info)) {
+        return CONTROL_DATA_LENGTH_ERROR;
+    }
+
     memset(payload, 0, payload_len);
 
     // rtos_printf("configuration_servicer_read_cmd, cmd_id: %d.\n", cmd_id);
@@ -98,6 +463,82 @@ control_ret_t configuration_servicer_read_cmd(control_resource_info_t *res_info,
             payload[1] = channel_1_stage;
         }
         break;
+        case CONFIGURATION_SERVICER_RESID_STAGE_PROFILE:
+        {
+            payload[0] = 0;
+            read_stage_profile(&payload[1]);
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_BYPASS_MASK:
+        {
+            payload[0] = 0;
+            payload[1] = audio_pipeline_ctrl_get_bypass();
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_AEC_FILTER_PHASES:
+        {
+            payload[0] = 0;
+            audio_pipeline_ctrl_get_aec_phases(&payload[1], &payload[2]);
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_MIC_DELAY:
+        {
+            int16_t delay = audio_pipeline_ctrl_get_mic_delay();
+            payload[0] = 0;
+            payload[1] = delay & 0xFF;
+            payload[2] = (delay >> 8) & 0xFF;
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_REF_RATE:
+        {
+            payload[0] = 0;
+            read_ref_rate(&payload[1]);
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_TDM_SLOT_MAP:
+        {
+            payload[0] = 0;
+            configuration_get_tdm_slot_map(&payload[1]);
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_WW_SCORE:
+        {
+            payload[0] = 0;
+            payload[1] = ww_score;
+            payload[2] = ww_detections;
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_SAVE_TUNABLES:
+        {
+            configuration_tunables_t t;
+            payload[0] = 0;
+            payload[1] = read_tunables(CONFIGURATION_FACTORY_ZONE, &t);
+            payload[2] = read_tunables(CONFIGURATION_CUSTOMER_ZONE, &t);
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_BATCH_READ:
+        {
+            ret = batch_read(&payload[1], payload_len - 1);
+            payload[0] = ret;
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_EVENTS:
+        {
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+            payload[0] = 0;
+            read_events(&payload[1]);
+#else
+            ret = CONTROL_BAD_COMMAND;
+            payload[0] = ret;
+#endif
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_TELEMETRY:
+        {
+            payload[0] = 0;
+            read_telemetry(&payload[1]);
+        }
+        break;
         default:
         {
             // rtos_printf("CONFIGURATION_SERVICER UNHANDLED COMMAND!!!\n");
@@ -124,7 +565,14 @@ control_ret_t configuration_servicer_write_cmd(control_resource_info_t *res_info
         {
             if (payload_len == 1)
             {
-                channel_0_stage = payload[0];
+                if (payload[0] <= PIPELINE_STAGE_AGC)
+                {
+                    channel_0_stage = payload[0];
+                }
+                else
+                {
+                    ret = CONTROL_ERROR;
+                }
             }
         }
         break;
@@ -132,7 +580,93 @@ control_ret_t configuration_servicer_write_cmd(control_resource_info_t *res_info
         {
             if (payload_len == 1)
             {
-                channel_1_stage = payload[0];
+                if (payload[0] <= PIPELINE_STAGE_AGC)
+                {
+                    channel_1_stage = payload[0];
+                }
+                else
+                {
+                    ret = CONTROL_ERROR;
+                }
+            }
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_BYPASS_MASK:
+        {
+            if (payload_len == 1)
+            {
+                audio_pipeline_ctrl_set_bypass(payload[0]);
+            }
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_AEC_FILTER_PHASES:
+        {
+            if (payload_len == 2)
+            {
+                if (audio_pipeline_ctrl_set_aec_phases(payload[0], payload[1]) != 0)
+                {
+                    ret = CONTROL_ERROR;
+                }
+            }
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_MIC_DELAY:
+        {
+            if (payload_len == 2)
+            {
+                int16_t delay = (int16_t)(payload[0] | (payload[1] << 8));
+                if (audio_pipeline_ctrl_set_mic_delay(delay) != 0)
+                {
+                    ret = CONTROL_ERROR;
+                }
+            }
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_TDM_SLOT_MAP:
+        {
+            if (payload_len == CONFIGURATION_SERVICER_TDM_SLOTS)
+            {
+                if (tdm_slot_map_valid(payload))
+                {
+                    memcpy(tdm_slot_map, payload, sizeof(tdm_slot_map));
+                }
+                else
+                {
+                    ret = CONTROL_ERROR;
+                }
+            }
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_SAVE_TUNABLES:
+        {
+            if (payload_len == 1)
+            {
+                if (save_tunables(payload[0]) != 0)
+                {
+                    ret = CONTROL_ERROR;
+                }
+            }
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_BATCH_READ:
+        {
+            ret = batch_select(payload, payload_len);
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_BATCH_WRITE:
+        {
+            ret = batch_write(payload, payload_len);
+        }
+        break;
+        case CONFIGURATION_SERVICER_RESID_TELEMETRY:
+        {
+            if (payload_len == sizeof(uint32_t))
+            {
+                telemetry_seq = payload[0] | (payload[1] << 8) | (payload[2] << 16) | ((uint32_t) payload[3] << 24);
+            }
+            else
+            {
+                ret = CONTROL_ERROR;
             }
         }
         break;
@@ -152,6 +686,29 @@ void configuration_push_vnr_value(int value)
     if (value > 100) value = 100;
     if (value < 0) value = 0;
     vnr_value = value;
+
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+    if (!voice_active && value >= appconfHOST_EVENT_VNR_ON) {
+        voice_active = 1;
+        host_events_push(HOST_EVENT_VOICE_START, value);
+    } else if (voice_active && value < appconfHOST_EVENT_VNR_OFF) {
+        voice_active = 0;
+        host_events_push(HOST_EVENT_VOICE_END, value);
+    }
+#endif
+}
+
+void configuration_push_ww_score(int value, int detected)
+{
+    if (value > 100) value = 100;
+    if (value < 0) value = 0;
+    ww_score = value;
+    if (detected) {
+        ww_detections++;
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+        host_events_push(HOST_EVENT_WAKE_WORD, value);
+#endif
+    }
 }
 
 enum e_pipeline_processing_stages configuration_get_channel_0_stage()
@@ -164,9 +721,22 @@ enum e_pipeline_processing_stages configuration_get_channel_1_stage()
     return channel_1_stage;
 }
 
-void configuration_read(uint8_t zone)
+void configuration_get_tdm_slot_map(uint8_t *map)
 {
-    // configuration_t c;
+    memcpy(map, tdm_slot_map, sizeof(tdm_slot_map));
+}
+
+void configuration_restore(void)
+{
+    configuration_tunables_t t;
+    const uint8_t zones[] = { CONFIGURATION_FACTORY_ZONE, CONFIGURATION_CUSTOMER_ZONE };
 
-    // configuration_read_from_flash(zone, )
-}
\ No newline at end of file
+    /* Customer values are applied last, so they win over factory values */
+    for (int i = 0; i < sizeof(zones); i++) {
+        uint8_t fields = read_tunables(zones[i], &t);
+        if (fields != 0) {
+            rtos_printf("restoring tunables 0x%02x from zone %d\n", fields, zones[i]);
+            apply_tunables(&t, fields);
+        }
+    }
+}
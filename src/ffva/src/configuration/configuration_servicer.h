@@ -5,18 +5,99 @@
 #define CONFIGURATION_SERVICER_RESID                    (241)
 #define NUM_RESOURCES_CONFIGURATION_SERVICER            (1) // Configuration servicer
 
+/* Command IDs must be below 0x80, which device control uses as the read bit */
 #define CONFIGURATION_SERVICER_RESID_VNR_VALUE          0x00
 
 #define CONFIGURATION_SERVICER_RESID_CHANNEL_0_STAGE    0x30
 #define CONFIGURATION_SERVICER_RESID_CHANNEL_1_STAGE    0x40
 
-#define NUM_CONFIGURATION_SERVICER_RESID_CMDS           3
+/* Per stage min, avg, max and p99 time per frame, in microseconds.
+ * Tile 1 stages are reported first, followed by tile 0 stages. */
+#define CONFIGURATION_SERVICER_RESID_STAGE_PROFILE      0x50
+#define CONFIGURATION_SERVICER_STAGE_PROFILE_STAGES     (6)
+#define CONFIGURATION_SERVICER_STAGE_PROFILE_VALS       (4)
+
+/* Bitmask of AP_BYPASS_* pipeline stages to skip */
+#define CONFIGURATION_SERVICER_RESID_BYPASS_MASK        0x60
+
+/* AEC main and shadow filter phases. Writes the pipeline cannot run are rejected */
+#define CONFIGURATION_SERVICER_RESID_AEC_FILTER_PHASES  0x70
+
+/* Static delay between the mics and the reference, in samples */
+#define CONFIGURATION_SERVICER_RESID_MIC_DELAY          0x08
+
+/* I2S reference clock offset from the mics in parts per billion, frames
+ * buffered between the clocks, and times that buffer ran dry or overflowed */
+#define CONFIGURATION_SERVICER_RESID_REF_RATE           0x10
+#define CONFIGURATION_SERVICER_REF_RATE_VALS            (3)
+
+/* Source of each I2S TDM slot. Bits 0-6 are the audio_pipeline_output()
+ * channel, or CONFIGURATION_TDM_SLOT_SILENT, and bit 7 is written to bit 0
+ * of each sample so that the host can tell processed audio from raw audio.
+ * Slots past appconfI2S_TDM_SLOTS are ignored */
+#define CONFIGURATION_SERVICER_RESID_TDM_SLOT_MAP       0x18
+#define CONFIGURATION_SERVICER_TDM_SLOTS                (16)
+#define CONFIGURATION_TDM_SLOT_SOURCES                  (6)
+#define CONFIGURATION_TDM_SLOT_SILENT                   0x7F
+#define CONFIGURATION_TDM_SLOT_TAG                      0x80
+
+/* Latest wake word score, 0-100, and wake words detected, modulo 256 */
+#define CONFIGURATION_SERVICER_RESID_WW_SCORE           0x20
+
+/* Writes CONFIGURATION_SAVE_* to save or clear the customer tunables.
+ * Reads the CONFIGURATION_TUNABLE_* fields saved in the factory zone,
+ * then those saved by the customer */
+#define CONFIGURATION_SERVICER_RESID_SAVE_TUNABLES      0x28
+#define CONFIGURATION_SAVE_CLEAR                        0
+#define CONFIGURATION_SAVE_CURRENT                      1
+
+/* Writing BATCH_READ selects up to CONFIGURATION_SERVICER_BATCH_MAX_CMDS
+ * command IDs. Reading it returns their values, in the order selected, each
+ * as read with its own command without the status byte */
+#define CONFIGURATION_SERVICER_RESID_BATCH_READ         0x38
+
+/* Command ID then value, for each of a list of writes. Either all are
+ * applied or, if any is rejected, none */
+#define CONFIGURATION_SERVICER_RESID_BATCH_WRITE        0x48
+
+/* Events for the host, oldest first: the number read, the number dropped
+ * since the last read, then up to CONFIGURATION_SERVICER_EVENTS_MAX of
+ * type, value and time in ms as a uint16. See host_events.h */
+#define CONFIGURATION_SERVICER_RESID_EVENTS             0x58
+#define CONFIGURATION_SERVICER_EVENTS_MAX               (15)
+#define CONFIGURATION_SERVICER_EVENT_BYTES              (4)
+
+/* Per frame pipeline history. Writing a uint32 record number sets where
+ * the next read starts. Reading returns the uint32 number of the first
+ * record, the number of records, then up to
+ * CONFIGURATION_SERVICER_TELEMETRY_MAX pipeline_telemetry_t records, and
+ * moves on past them. See pipeline_telemetry.h */
+#define CONFIGURATION_SERVICER_RESID_TELEMETRY          0x68
+#define CONFIGURATION_SERVICER_TELEMETRY_MAX            (7)
+#define CONFIGURATION_SERVICER_TELEMETRY_BYTES          (8)
+
+#define CONFIGURATION_SERVICER_BATCH_MAX_CMDS           (8)
+#define CONFIGURATION_SERVICER_BATCH_MAX_BYTES          (64)
+
+#define NUM_CONFIGURATION_SERVICER_RESID_CMDS           15
 
 static control_cmd_info_t configuration_servicer_resid_cmd_map[] =
 {
     { CONFIGURATION_SERVICER_RESID_VNR_VALUE, 1, sizeof(uint8_t), CMD_READ_ONLY },
     { CONFIGURATION_SERVICER_RESID_CHANNEL_0_STAGE, 1, sizeof(uint8_t), CMD_READ_WRITE },
     { CONFIGURATION_SERVICER_RESID_CHANNEL_1_STAGE, 1, sizeof(uint8_t), CMD_READ_WRITE },
+    { CONFIGURATION_SERVICER_RESID_STAGE_PROFILE, CONFIGURATION_SERVICER_STAGE_PROFILE_STAGES * CONFIGURATION_SERVICER_STAGE_PROFILE_VALS, sizeof(uint16_t), CMD_READ_ONLY },
+    { CONFIGURATION_SERVICER_RESID_BYPASS_MASK, 1, sizeof(uint8_t), CMD_READ_WRITE },
+    { CONFIGURATION_SERVICER_RESID_AEC_FILTER_PHASES, 2, sizeof(uint8_t), CMD_READ_WRITE },
+    { CONFIGURATION_SERVICER_RESID_MIC_DELAY, 1, sizeof(int16_t), CMD_READ_WRITE },
+    { CONFIGURATION_SERVICER_RESID_REF_RATE, CONFIGURATION_SERVICER_REF_RATE_VALS, sizeof(int32_t), CMD_READ_ONLY },
+    { CONFIGURATION_SERVICER_RESID_TDM_SLOT_MAP, CONFIGURATION_SERVICER_TDM_SLOTS, sizeof(uint8_t), CMD_READ_WRITE },
+    { CONFIGURATION_SERVICER_RESID_WW_SCORE, 2, sizeof(uint8_t), CMD_READ_ONLY },
+    { CONFIGURATION_SERVICER_RESID_SAVE_TUNABLES, 2, sizeof(uint8_t), CMD_READ_WRITE },
+    { CONFIGURATION_SERVICER_RESID_BATCH_READ, CONFIGURATION_SERVICER_BATCH_MAX_BYTES, sizeof(uint8_t), CMD_READ_WRITE },
+    { CONFIGURATION_SERVICER_RESID_BATCH_WRITE, CONFIGURATION_SERVICER_BATCH_MAX_BYTES, sizeof(uint8_t), CMD_WRITE_ONLY },
+    { CONFIGURATION_SERVICER_RESID_EVENTS, 2 + CONFIGURATION_SERVICER_EVENTS_MAX * CONFIGURATION_SERVICER_EVENT_BYTES, sizeof(uint8_t), CMD_READ_ONLY },
+    { CONFIGURATION_SERVICER_RESID_TELEMETRY, 5 + CONFIGURATION_SERVICER_TELEMETRY_MAX * CONFIGURATION_SERVICER_TELEMETRY_BYTES, sizeof(uint8_t), CMD_READ_WRITE },
 };
 
 enum e_pipeline_processing_stages
@@ -27,6 +108,37 @@ enum e_pipeline_processing_stages
     PIPELINE_STAGE_NS = 3,
     PIPELINE_STAGE_AGC = 4,
 };
+/* Fields of a tunables record */
+#define CONFIGURATION_TUNABLE_CHANNEL_STAGES    (1 << 0)
+#define CONFIGURATION_TUNABLE_BYPASS_MASK       (1 << 1)
+#define CONFIGURATION_TUNABLE_AEC_PHASES        (1 << 2)
+#define CONFIGURATION_TUNABLE_MIC_DELAY         (1 << 3)
+#define CONFIGURATION_TUNABLE_TDM_SLOT_MAP      (1 << 4)
+#define CONFIGURATION_TUNABLE_ALL               (0x1F)
+
+#define CONFIGURATION_TUNABLES_MAGIC            0x5554  /* "TU" */
+#define CONFIGURATION_TUNABLES_VERSION          1
+
+/*
+ * Tunables as saved in flash. The factory zone may hold one at its start,
+ * and the customer's is kept in the configuration store. Only the values
+ * whose bit is set in fields are applied. Each value is as written with
+ * the command of the same name. All members are bytes, so the layout is
+ * the same on the host.
+ */
+typedef struct {
+    uint8_t magic[2];           /* CONFIGURATION_TUNABLES_MAGIC, little endian */
+    uint8_t version;
+    uint8_t fields;             /* CONFIGURATION_TUNABLE_* values present */
+    uint8_t channel_0_stage;
+    uint8_t channel_1_stage;
+    uint8_t bypass_mask;
+    uint8_t aec_main_phases;
+    uint8_t aec_shadow_phases;
+    uint8_t mic_delay[2];       /* int16, little endian */
+    uint8_t tdm_slot_map[CONFIGURATION_SERVICER_TDM_SLOTS];
+} configuration_tunables_t;
+
 // typedef struct {
 //     uint8_t hdr;
 //     uint8_t resid;
@@ -51,5 +163,19 @@ control_ret_t configuration_servicer_write_cmd(control_resource_info_t *res_info
 
 void configuration_push_vnr_value(int value);
 
+/* Records a wake word score, 0-100, and counts it as a detection if detected is set */
+void configuration_push_ww_score(int value, int detected);
+
 enum e_pipeline_processing_stages configuration_get_channel_0_stage();
-enum e_pipeline_processing_stages configuration_get_channel_1_stage();
\ No newline at end of file
+enum e_pipeline_processing_stages configuration_get_channel_1_stage();
+
+/* Copies the CONFIGURATION_SERVICER_TDM_SLOTS entry TDM slot map */
+void configuration_get_tdm_slot_map(uint8_t *map);
+
+/*
+ * Applies the tunables saved in the factory zone, then those saved by the
+ * customer over them. Called once on tile 0 before audio_pipeline_init()
+ * and before the configuration servicer starts, so that both start with
+ * them. The AEC phases and mic delay are checked by the pipeline init.
+ */
+void configuration_restore(void);
\ No newline at end of file
@@ -0,0 +1,109 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_conf.h"
+#include "feature_cache/feature_cache.h"
+
+#if appconfFEATURE_CACHE_ENABLED && ON_TILE(FEATURE_CACHE_TILE_NO)
+
+#define FEATURE_CACHE_NOTIFY_INDEX  (1) /* Index 0 is left to the application */
+
+static feature_frontend_t frontend;
+static feature_frame_t ring[appconfFEATURE_CACHE_FRAMES];
+
+/* Frames published since start up. Frame n is in ring[n % appconfFEATURE_CACHE_FRAMES] */
+static volatile uint32_t published;
+
+/* Samples of a hop split across pipeline frames */
+static int32_t pending[FEATURE_FRONTEND_HOP];
+static size_t pending_count;
+
+static TaskHandle_t readers[FEATURE_CACHE_MAX_READERS];
+static volatile int reader_count;
+
+static void publish(const int32_t *hop, size_t stride)
+{
+    /* The slot of the oldest frame is rewritten in place, readers check for this after copying */
+    feature_frontend_process(&frontend, hop, stride, &ring[published % appconfFEATURE_CACHE_FRAMES]);
+    published++;
+
+    for (int i = 0; i < reader_count; i++) {
+        xTaskNotifyGiveIndexed(readers[i], FEATURE_CACHE_NOTIFY_INDEX);
+    }
+}
+
+void feature_cache_init(void)
+{
+    feature_frontend_init(&frontend);
+    published = 0;
+    pending_count = 0;
+}
+
+void feature_cache_push(const int32_t *samples, size_t stride, size_t frame_count)
+{
+    while (frame_count > 0) {
+        /* Whole hops are read straight from the caller's frame */
+        if (pending_count == 0 && frame_count >= FEATURE_FRONTEND_HOP) {
+            publish(samples, stride);
+            samples += FEATURE_FRONTEND_HOP * stride;
+            frame_count -= FEATURE_FRONTEND_HOP;
+            continue;
+        }
+
+        size_t n = FEATURE_FRONTEND_HOP - pending_count;
+        if (n > frame_count) {
+            n = frame_count;
+        }
+        for (size_t i = 0; i < n; i++) {
+            pending[pending_count + i] = samples[i * stride];
+        }
+        pending_count += n;
+        samples += n * stride;
+        frame_count -= n;
+
+        if (pending_count == FEATURE_FRONTEND_HOP) {
+            publish(pending, 1);
+            pending_count = 0;
+        }
+    }
+}
+
+uint32_t feature_cache_attach(void)
+{
+    configASSERT(reader_count < FEATURE_CACHE_MAX_READERS);
+
+    readers[reader_count] = xTaskGetCurrentTaskHandle();
+    reader_count++;
+    return published;
+}
+
+void feature_cache_read(uint32_t index, feature_frame_t *frame)
+{
+    for (;;) {
+        uint32_t head = published;
+
+        if ((int32_t) (index - head) >= 0) {
+            ulTaskNotifyTakeIndexed(FEATURE_CACHE_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        /* The slot of frame head - appconfFEATURE_CACHE_FRAMES is the one being rewritten next */
+        if (head - index >= appconfFEATURE_CACHE_FRAMES) {
+            index = head - appconfFEATURE_CACHE_FRAMES + 1;
+        }
+
+        memcpy(frame, &ring[index % appconfFEATURE_CACHE_FRAMES], sizeof(*frame));
+
+        /* Keep the copy only if the writer did not start on its slot meanwhile */
+        if (published - index < appconfFEATURE_CACHE_FRAMES) {
+            return;
+        }
+    }
+}
+
+#endif /* appconfFEATURE_CACHE_ENABLED && ON_TILE(FEATURE_CACHE_TILE_NO) */
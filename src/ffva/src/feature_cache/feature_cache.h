@@ -0,0 +1,54 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef FEATURE_CACHE_H_
+#define FEATURE_CACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "feature_cache/feature_frontend.h"
+
+/* Most tasks that can wait on the cache */
+#define FEATURE_CACHE_MAX_READERS   (2)
+
+/*
+ * Features of the ASR output, made once per hop in the pipeline output path
+ * and kept in a ring of appconfFEATURE_CACHE_FRAMES frames that any task on
+ * FEATURE_CACHE_TILE_NO can read by frame index. Models that take features
+ * rather than audio read them from here, so the spectrum is computed once
+ * however many of them run.
+ *
+ * audio_pipeline_output() is the only writer. A reader that falls more than
+ * the ring behind skips to the oldest frame still held. Readers are woken
+ * with task notification index 1, index 0 is left to the application.
+ */
+
+/**
+ * Sets up the frontend and empties the ring. Called once at start up,
+ * before the pipeline runs.
+ */
+void feature_cache_init(void);
+
+/**
+ * Adds frame_count samples, spaced stride words apart, and publishes a
+ * frame of features each time a hop completes.
+ */
+void feature_cache_push(const int32_t *samples, size_t stride, size_t frame_count);
+
+/**
+ * Registers the calling task to be woken as frames are published. At most
+ * FEATURE_CACHE_MAX_READERS tasks may attach.
+ *
+ * \returns the index of the next frame to be published.
+ */
+uint32_t feature_cache_attach(void);
+
+/**
+ * Copies out the frame at index, waiting for it if it has not been
+ * published yet. If it has already been overwritten, the oldest frame held
+ * is copied instead. Either way the next frame to read is frame->index + 1.
+ */
+void feature_cache_read(uint32_t index, feature_frame_t *frame);
+
+#endif /* FEATURE_CACHE_H_ */
@@ -0,0 +1,138 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <math.h>
+#include <string.h>
+
+#include "xmath/xmath.h"
+
+#include "app_conf.h"
+#include "feature_cache/feature_frontend.h"
+
+#if appconfFEATURE_CACHE_ENABLED
+
+#define SAMPLE_RATE     (16000)
+#define MEL_LOW_HZ      (125.0f)
+#define MEL_HIGH_HZ     (7500.0f)
+
+/* Added to each band energy so that silence does not take the log of 0 */
+#define LOG_FLOOR       (1e-6f)
+
+/* Bins below the first band or above the last */
+#define MEL_BAND_NONE   (-2)
+
+#define PI              (3.14159265358979f)
+
+static float hz_to_mel(float hz)
+{
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+static void mel_tables_init(feature_frontend_t *ctx)
+{
+    float edges[FEATURE_FRONTEND_MEL_BANDS + 2];
+    const float mel_low = hz_to_mel(MEL_LOW_HZ);
+    const float mel_step = (hz_to_mel(MEL_HIGH_HZ) - mel_low) / (FEATURE_FRONTEND_MEL_BANDS + 1);
+
+    for (int i = 0; i < FEATURE_FRONTEND_MEL_BANDS + 2; i++) {
+        edges[i] = mel_low + i * mel_step;
+    }
+
+    /*
+     * A bin between edges j and j + 1 is on the falling slope of band j - 1,
+     * which peaks at edge j, and the rising slope of band j. The first and
+     * last bands only have one neighbour, which is dropped in process.
+     */
+    for (int k = 0; k < FEATURE_FRONTEND_FFT_BINS; k++) {
+        float mel = hz_to_mel((float) k * SAMPLE_RATE / FEATURE_FRONTEND_FFT_LENGTH);
+
+        ctx->mel_band[k] = MEL_BAND_NONE;
+        ctx->mel_weight[k] = 0.0f;
+        for (int j = 0; j < FEATURE_FRONTEND_MEL_BANDS + 1; j++) {
+            if (mel >= edges[j] && mel < edges[j + 1]) {
+                ctx->mel_band[k] = j - 1;
+                ctx->mel_weight[k] = (edges[j + 1] - mel) / mel_step;
+                break;
+            }
+        }
+    }
+}
+
+/*
+ * Power of bin k of a real FFT from fft_f32_forward(), which packs the
+ * real Nyquist bin into the imaginary part of the real DC bin.
+ */
+static float bin_power(const complex_float_t *spectrum, int k)
+{
+    if (k == 0) {
+        return spectrum[0].re * spectrum[0].re;
+    }
+    if (k == FEATURE_FRONTEND_FFT_LENGTH / 2) {
+        return spectrum[0].im * spectrum[0].im;
+    }
+    return spectrum[k].re * spectrum[k].re + spectrum[k].im * spectrum[k].im;
+}
+
+void feature_frontend_init(feature_frontend_t *ctx)
+{
+    memset(ctx, 0x00, sizeof(*ctx));
+
+    for (int i = 0; i < FEATURE_FRONTEND_WINDOW; i++) {
+        ctx->window[i] = 0.5f - 0.5f * cosf(2.0f * PI * i / FEATURE_FRONTEND_WINDOW);
+    }
+
+    mel_tables_init(ctx);
+}
+
+void feature_frontend_process(feature_frontend_t *ctx,
+                              const int32_t *hop,
+                              size_t stride,
+                              feature_frame_t *frame)
+{
+    const int history_len = FEATURE_FRONTEND_WINDOW - FEATURE_FRONTEND_HOP;
+
+    for (int i = 0; i < history_len; i++) {
+        ctx->fft[i] = ctx->history[i] * ctx->window[i];
+    }
+    for (int i = 0; i < FEATURE_FRONTEND_HOP; i++) {
+        ctx->fft[history_len + i] = hop[i * stride] * ctx->window[history_len + i];
+    }
+    memset(&ctx->fft[FEATURE_FRONTEND_WINDOW], 0x00, (FEATURE_FRONTEND_FFT_LENGTH - FEATURE_FRONTEND_WINDOW) * sizeof(float));
+
+    /* The next window starts history_len samples before the end of this one */
+    memmove(ctx->history, &ctx->history[FEATURE_FRONTEND_HOP], (history_len - FEATURE_FRONTEND_HOP) * sizeof(int32_t));
+    for (int i = 0; i < FEATURE_FRONTEND_HOP; i++) {
+        ctx->history[history_len - FEATURE_FRONTEND_HOP + i] = hop[i * stride];
+    }
+
+    const complex_float_t *spectrum = fft_f32_forward(ctx->fft, FEATURE_FRONTEND_FFT_LENGTH);
+
+    for (int b = 0; b < FEATURE_FRONTEND_MEL_BANDS; b++) {
+        frame->mel[b] = 0.0f;
+    }
+
+    /* Samples are full scale at 2^31, so power is scaled back to full scale at 1 */
+    const float scale = 1.0f / ((float) (1ull << 31) * (float) (1ull << 31));
+    for (int k = 0; k < FEATURE_FRONTEND_FFT_BINS; k++) {
+        const float power = bin_power(spectrum, k) * scale;
+
+        const int band = ctx->mel_band[k];
+        if (band == MEL_BAND_NONE) {
+            continue;
+        }
+        if (band >= 0) {
+            frame->mel[band] += power * ctx->mel_weight[k];
+        }
+        if (band + 1 < FEATURE_FRONTEND_MEL_BANDS) {
+            frame->mel[band + 1] += power * (1.0f - ctx->mel_weight[k]);
+        }
+    }
+
+    for (int b = 0; b < FEATURE_FRONTEND_MEL_BANDS; b++) {
+        frame->mel[b] = logf(frame->mel[b] + LOG_FLOOR);
+    }
+
+    frame->index = ctx->hops++;
+}
+
+#endif /* appconfFEATURE_CACHE_ENABLED */
@@ -0,0 +1,62 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef FEATURE_FRONTEND_H_
+#define FEATURE_FRONTEND_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* New samples per feature frame, 10 ms at 16 kHz */
+#define FEATURE_FRONTEND_HOP         (160)
+
+/* Samples in each analysis window, 25 ms at 16 kHz */
+#define FEATURE_FRONTEND_WINDOW      (400)
+
+/* Real FFT length the window is zero padded to */
+#define FEATURE_FRONTEND_FFT_LENGTH  (512)
+#define FEATURE_FRONTEND_FFT_BINS    (FEATURE_FRONTEND_FFT_LENGTH / 2 + 1)
+
+/* Mel bands per feature frame, spaced from 125 Hz to 7.5 kHz */
+#define FEATURE_FRONTEND_MEL_BANDS   (40)
+
+/* The features of one hop of audio */
+typedef struct {
+    uint32_t index;                             /* Hops since the frontend was initialised */
+    float mel[FEATURE_FRONTEND_MEL_BANDS];      /* Natural log of each mel band's energy */
+} feature_frame_t;
+
+/*
+ * Spectral frontend for the speech models on the ASR output. Each call takes
+ * one hop of audio and produces one frame of features from the last window
+ * of audio, so the work is spread evenly over the 10 ms hops rather than
+ * done a model input at a time. Models must be trained on features made
+ * with the same parameters: a Hann window, the power spectrum, triangular
+ * mel bands, and the natural log of each band's energy.
+ */
+typedef struct {
+    int32_t history[FEATURE_FRONTEND_WINDOW - FEATURE_FRONTEND_HOP];
+    uint32_t hops;
+    float window[FEATURE_FRONTEND_WINDOW];
+    /* Each bin adds mel_weight of its power to band mel_band, and the rest to the band above */
+    int8_t mel_band[FEATURE_FRONTEND_FFT_BINS];
+    float mel_weight[FEATURE_FRONTEND_FFT_BINS];
+    /* The windowed audio, transformed in place by lib_xcore_math */
+    float fft[FEATURE_FRONTEND_FFT_LENGTH] __attribute__((aligned(8)));
+} feature_frontend_t;
+
+/**
+ * Sets up the window and mel band tables, and clears the history.
+ */
+void feature_frontend_init(feature_frontend_t *ctx);
+
+/**
+ * Takes FEATURE_FRONTEND_HOP new 32 bit samples, spaced stride words
+ * apart, and writes the features of the window ending with them to frame.
+ */
+void feature_frontend_process(feature_frontend_t *ctx,
+                              const int32_t *hop,
+                              size_t stride,
+                              feature_frame_t *frame);
+
+#endif /* FEATURE_FRONTEND_H_ */
@@ -7,6 +7,7 @@
 
 #include "platform/app_pll_ctrl.h"
 #include "gpio_test/gpio_test.h"
+#include "host_events/host_events.h"
 
 #if XK_VOICE_L71
 #define BUTTON_MUTE_BITMASK PIN_MUTE_DET_IN
@@ -72,9 +73,15 @@ static void gpio_handler(rtos_gpio_t *gpio_ctx)
         if (((gpio_val & BUTTON_MUTE_BITMASK) != 0) && (mute_status != 1)) {
             rtos_printf("Mute active\n");
             mute_status = 1;
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+            host_events_push(HOST_EVENT_MUTE, 1);
+#endif
         } else if (((gpio_val & BUTTON_MUTE_BITMASK) == 0) && (mute_status != 0)) {
             rtos_printf("Mute inactive\n");
             mute_status = 0;
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+            host_events_push(HOST_EVENT_MUTE, 0);
+#endif
         }
 
         if ((gpio_val & BUTTON_BTN_BITMASK) == 0 && button_status != 1) {
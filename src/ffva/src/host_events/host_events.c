@@ -0,0 +1,80 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <platform.h>
+#include <xcore/hwtimer.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "app_conf.h"
+#include "platform/driver_instances.h"
+#include "platform/platform_init.h"
+#include "host_events/host_events.h"
+
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+
+#define REF_TICKS_PER_MS    (100000)
+
+static host_event_t fifo[HOST_EVENTS_FIFO_DEPTH];
+static uint32_t pushed;     /* Event n is in fifo[n % HOST_EVENTS_FIFO_DEPTH] */
+static uint32_t popped;
+static uint8_t dropped;
+
+/* Called in a critical section, so that the pin follows the queue */
+static void host_interrupt_set(int level)
+{
+    platform_gpo_set(PIN_ESPIO41, level ? PIN_ESPIO41 : 0);
+}
+
+void host_events_init(void)
+{
+    taskENTER_CRITICAL();
+    pushed = 0;
+    popped = 0;
+    dropped = 0;
+    host_interrupt_set(0);
+    taskEXIT_CRITICAL();
+}
+
+void host_events_push(uint8_t type, uint8_t value)
+{
+    const host_event_t event = {
+        .type = type,
+        .value = value,
+        .time_ms = (get_reference_time() / REF_TICKS_PER_MS) & 0xFFFF,
+    };
+
+    taskENTER_CRITICAL();
+    if (pushed - popped < HOST_EVENTS_FIFO_DEPTH) {
+        fifo[pushed % HOST_EVENTS_FIFO_DEPTH] = event;
+        pushed++;
+        if (pushed - popped == 1) {
+            host_interrupt_set(1);
+        }
+    } else if (dropped < UINT8_MAX) {
+        dropped++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+size_t host_events_read(host_event_t *events, size_t max, uint8_t *lost)
+{
+    size_t count = 0;
+
+    taskENTER_CRITICAL();
+    while (count < max && popped != pushed) {
+        events[count++] = fifo[popped % HOST_EVENTS_FIFO_DEPTH];
+        popped++;
+    }
+    *lost = dropped;
+    dropped = 0;
+    if (count > 0 && popped == pushed) {
+        host_interrupt_set(0);
+    }
+    taskEXIT_CRITICAL();
+
+    return count;
+}
+
+#endif /* appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO) */
@@ -0,0 +1,56 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef HOST_EVENTS_H_
+#define HOST_EVENTS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Events for the host, queued on HOST_EVENTS_TILE_NO and read with the
+ * configuration servicer EVENTS command. The host interrupt pin is high
+ * from the first event queued until the queue is read empty, so the host
+ * does not need to poll.
+ *
+ * Events are pushed from any task on HOST_EVENTS_TILE_NO. When the queue
+ * is full new events are dropped and counted, so those queued stay in
+ * order.
+ */
+
+/* Event types. The value of each is given after it */
+#define HOST_EVENT_VOICE_START  (1) /* VNR, 0-100, on rising to appconfHOST_EVENT_VNR_ON */
+#define HOST_EVENT_VOICE_END    (2) /* VNR, 0-100, on falling below appconfHOST_EVENT_VNR_OFF */
+#define HOST_EVENT_WAKE_WORD    (3) /* Wake word score, 0-100 */
+#define HOST_EVENT_MUTE         (4) /* 1 when the mute switch is on, 0 when it is off */
+
+#define HOST_EVENTS_FIFO_DEPTH  (32)
+
+typedef struct {
+    uint8_t type;
+    uint8_t value;
+    uint16_t time_ms;       /* Reference clock time of the event, modulo 65536 ms */
+} host_event_t;
+
+/**
+ * Drives the host interrupt pin low. Called once on HOST_EVENTS_TILE_NO,
+ * after the GPIO driver is started.
+ */
+void host_events_init(void);
+
+/**
+ * Queues an event and raises the host interrupt pin if it was low.
+ */
+void host_events_push(uint8_t type, uint8_t value);
+
+/**
+ * Copies up to max events, oldest first, out of the queue. The host
+ * interrupt pin is lowered once the queue is empty.
+ *
+ * \param lost      set to the events dropped since the last call, up to 255
+ *
+ * \returns the events copied.
+ */
+size_t host_events_read(host_event_t *events, size_t max, uint8_t *lost);
+
+#endif /* HOST_EVENTS_H_ */
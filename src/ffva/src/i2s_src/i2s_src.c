@@ -0,0 +1,41 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include "i2s_src.h"
+
+void i2s_src_upsample(i2s_src_t *src,
+                      int32_t (*dst)[I2S_SRC_CHANNELS],
+                      int32_t (*in)[I2S_SRC_CHANNELS],
+                      size_t frame_count)
+{
+    for (int ch = 0; ch < I2S_SRC_CHANNELS; ch++) {
+        int32_t *data = src->us_data[ch];
+
+        for (size_t i = 0; i < frame_count; i++) {
+            int32_t (*out)[I2S_SRC_CHANNELS] = &dst[I2S_SRC_FACTOR * i];
+
+            out[0][ch] = src_us3_voice_input_sample(data, src_ff3v_fir_coefs[2], in[i][ch]);
+            out[1][ch] = src_us3_voice_get_next_sample(data, src_ff3v_fir_coefs[1]);
+            out[2][ch] = src_us3_voice_get_next_sample(data, src_ff3v_fir_coefs[0]);
+        }
+    }
+}
+
+void i2s_src_downsample(i2s_src_t *src,
+                        int32_t (*dst)[I2S_SRC_CHANNELS],
+                        int32_t (*in)[I2S_SRC_CHANNELS],
+                        size_t frame_count)
+{
+    for (int ch = 0; ch < I2S_SRC_CHANNELS; ch++) {
+        int32_t (*data)[SRC_FF3V_FIR_TAPS_PER_PHASE] = src->ds_data[ch];
+
+        for (size_t i = 0; i < frame_count; i++) {
+            int32_t (*x)[I2S_SRC_CHANNELS] = &in[I2S_SRC_FACTOR * i];
+            int64_t sum;
+
+            sum = src_ds3_voice_add_sample(0, data[0], src_ff3v_fir_coefs[0], x[0][ch]);
+            sum = src_ds3_voice_add_sample(sum, data[1], src_ff3v_fir_coefs[1], x[1][ch]);
+            dst[i][ch] = src_ds3_voice_add_final_sample(sum, data[2], src_ff3v_fir_coefs[2], x[2][ch]);
+        }
+    }
+}
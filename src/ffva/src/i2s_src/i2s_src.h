@@ -0,0 +1,46 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef I2S_SRC_H_
+#define I2S_SRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "src.h"
+
+/* Channels per I2S frame */
+#define I2S_SRC_CHANNELS    (2)
+
+/* Factor between the I2S rate and the pipeline rate, as fixed by the lib_src voice filters */
+#define I2S_SRC_FACTOR      (3)
+
+/*
+ * Rate conversion between a 3x rate I2S instance and the pipeline, a
+ * block at a time, in the calling task. Each direction keeps its own
+ * filter state, so one task can receive while another sends. A zeroed
+ * struct is ready to use.
+ */
+typedef struct {
+    int32_t us_data[I2S_SRC_CHANNELS][SRC_FF3V_FIR_TAPS_PER_PHASE] __attribute__((aligned(8)));
+    int32_t ds_data[I2S_SRC_CHANNELS][SRC_FF3V_FIR_NUM_PHASES][SRC_FF3V_FIR_TAPS_PER_PHASE] __attribute__((aligned(8)));
+} i2s_src_t;
+
+/**
+ * Converts frame_count pipeline rate frames to I2S_SRC_FACTOR * frame_count
+ * I2S rate frames. Both are in sample channel format.
+ */
+void i2s_src_upsample(i2s_src_t *src,
+                      int32_t (*dst)[I2S_SRC_CHANNELS],
+                      int32_t (*in)[I2S_SRC_CHANNELS],
+                      size_t frame_count);
+
+/**
+ * Converts I2S_SRC_FACTOR * frame_count I2S rate frames to frame_count
+ * pipeline rate frames. Both are in sample channel format.
+ */
+void i2s_src_downsample(i2s_src_t *src,
+                        int32_t (*dst)[I2S_SRC_CHANNELS],
+                        int32_t (*in)[I2S_SRC_CHANNELS],
+                        size_t frame_count);
+
+#endif /* I2S_SRC_H_ */
@@ -23,16 +23,39 @@
 #include "usb_support.h"
 // #include "usb_audio.h"
 #include "audio_pipeline.h"
-// #include "ww_model_runner/ww_model_runner.h"
+#include "frame_pool.h"
+#include "ww_model_runner/ww_model_runner.h"
+#include "feature_cache/feature_cache.h"
 // #include "fs_support.h"
 #include "dfu_servicer.h"
 #include "configuration_servicer.h"
 
 #include "gpio_test/gpio_test.h"
+#include "host_events/host_events.h"
+#include "output_router/output_router.h"
+#include "i2s_src/i2s_src.h"
+#include "ref_asrc/ref_asrc.h"
 
 volatile int mic_from_usb = appconfMIC_SRC_DEFAULT;
 volatile int aec_ref_source = appconfAEC_REF_DEFAULT;
 
+#if appconfI2S_ENABLED && (appconfI2S_SRC_FACTOR == I2S_SRC_FACTOR)
+#define I2S_SRC_ENABLED    1
+
+/* i2s1 is received by the pipeline input and sent by the I2S slave output, i2s2 by the I2S master output */
+static i2s_src_t i2s1_src;
+#else
+#define I2S_SRC_ENABLED    0
+#endif
+
+#if appconfI2S_REF_ASRC_ENABLED
+/* I2S reference frames between the ASRC and the pipeline, for one pipeline frame plus the lock margins */
+#define REF_ASRC_FIFO_FRAMES   (I2S_SRC_FACTOR * appconfAUDIO_PIPELINE_FRAME_ADVANCE + 4 * REF_ASRC_TARGET_FRAMES)
+
+static ref_asrc_t ref_asrc;
+static int32_t ref_asrc_fifo[REF_ASRC_FIFO_FRAMES][REF_ASRC_CHANNELS];
+#endif
+
 #if appconfI2S_ENABLED && (appconfI2S_MODE == appconfI2S_MODE_SLAVE)
 void i2s_slave_intertile(void *args) {
     (void) args;
@@ -54,10 +77,20 @@ void i2s_slave_intertile(void *args) {
                 tmp,
                 bytes_received);
 
+#if I2S_SRC_ENABLED
+        int32_t tx_frame[I2S_SRC_FACTOR * appconfAUDIO_PIPELINE_FRAME_ADVANCE][appconfAUDIO_PIPELINE_CHANNELS];
+
+        i2s_src_upsample(&i2s1_src, tx_frame, tmp, appconfAUDIO_PIPELINE_FRAME_ADVANCE);
+        rtos_i2s_tx(i2s1_ctx,
+                    (int32_t*) tx_frame,
+                    I2S_SRC_FACTOR * appconfAUDIO_PIPELINE_FRAME_ADVANCE,
+                    portMAX_DELAY);
+#else
         rtos_i2s_tx(i2s1_ctx,
                     (int32_t*) tmp,
                     appconfAUDIO_PIPELINE_FRAME_ADVANCE,
                     portMAX_DELAY);
+#endif
     }
 }
 #endif
@@ -119,21 +152,74 @@ void audio_pipeline_input(void *input_app_data,
                    ch_cnt);
 #endif
 
+#if !appconfI2S_ENABLED
+    if (!appconfUSB_ENABLED || aec_ref_source != appconfAEC_REF_USB) {
+        /* No reference source. Pipeline frames are reused, not cleared, so zero it here */
+        memset(input_audio_frames, 0x00, 2 * frame_count * sizeof(int32_t));
+    }
+#endif
+
 #if appconfI2S_ENABLED
     if (!appconfUSB_ENABLED || aec_ref_source == appconfAEC_REF_I2S) {
-        /* This shouldn't need to block given it shares a clock with the PDM mics */
+        /*
+         * This shouldn't need to block given it shares a clock with the PDM mics.
+         * With the ASRC, the I2S master has its own clock, so it never blocks.
+         */
 
         xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
         /* I2S provides sample channel format */
         int32_t tmp[appconfAUDIO_PIPELINE_FRAME_ADVANCE][appconfAUDIO_PIPELINE_CHANNELS];
         int32_t *tmpptr = (int32_t *)input_audio_frames;
 
+#if I2S_SRC_ENABLED
+        /* The whole frame is converted here, in the pipeline task rather than in the I2S interrupt */
+        int32_t rx_frame[I2S_SRC_FACTOR * appconfAUDIO_PIPELINE_FRAME_ADVANCE][appconfAUDIO_PIPELINE_CHANNELS];
+
+#if appconfI2S_REF_ASRC_ENABLED
+        static int ref_asrc_started;
+        if (!ref_asrc_started) {
+            ref_asrc_init(&ref_asrc, FS_CODE_48, ref_asrc_fifo, REF_ASRC_FIFO_FRAMES, I2S_SRC_FACTOR * frame_count);
+            ref_asrc_started = 1;
+        }
+
+        /* Convert everything that has arrived since the last frame, then take a frame on the mic clock */
+        int32_t rx_block[REF_ASRC_BLOCK_FRAMES][REF_ASRC_CHANNELS];
+        while (rtos_i2s_rx(i2s1_ctx, (int32_t*) rx_block, REF_ASRC_BLOCK_FRAMES, 0) == REF_ASRC_BLOCK_FRAMES) {
+            ref_asrc_push(&ref_asrc, rx_block);
+        }
+        ref_asrc_pull(&ref_asrc, rx_frame);
+#else
+        size_t rx_count =
+        rtos_i2s_rx(i2s1_ctx,
+                    (int32_t*) rx_frame,
+                    I2S_SRC_FACTOR * frame_count,
+                    portMAX_DELAY);
+        xassert(rx_count == I2S_SRC_FACTOR * frame_count);
+#endif
+
+        i2s_src_downsample(&i2s1_src, tmp, rx_frame, frame_count);
+#elif appconfI2S_SRC_FACTOR != 1
+        /*
+         * TDM with more than 6 slots, only built with a USB reference. There is no converter for
+         * this rate, so if the reference is switched to I2S the input keeps time but is silent.
+         */
+        for (int i = 0; i < appconfI2S_SRC_FACTOR; i++) {
+            size_t rx_count =
+            rtos_i2s_rx(i2s1_ctx,
+                        (int32_t*) tmp,
+                        frame_count,
+                        portMAX_DELAY);
+            xassert(rx_count == frame_count);
+        }
+        memset(tmp, 0x00, sizeof(tmp));
+#else
         size_t rx_count =
         rtos_i2s_rx(i2s1_ctx,
                     (int32_t*) tmp,
                     frame_count,
                     portMAX_DELAY);
         xassert(rx_count == frame_count);
+#endif
 
         for (int i=0; i<frame_count; i++) {
             /* ref is first */
@@ -144,6 +230,157 @@ void audio_pipeline_input(void *input_app_data,
 #endif
 }
 
+void audio_pipeline_input_status(void *input_app_data,
+                                 audio_pipeline_input_status_t *status)
+{
+    (void) input_app_data;
+
+#if appconfI2S_REF_ASRC_ENABLED
+    ref_asrc_status_t asrc_status;
+
+    ref_asrc_get_status(&ref_asrc, &asrc_status);
+    status->ref_rate_ppb = asrc_status.rate_ppb;
+    status->ref_fill = asrc_status.fill;
+    status->ref_xruns = asrc_status.xruns;
+#else
+    /* The reference shares the mic clock */
+    (void) status;
+#endif
+}
+
+#define I2S_MASTER_OUTPUT  (appconfI2S_ENABLED && (appconfI2S_MODE == appconfI2S_MODE_MASTER) && !appconfI2S_TDM_ENABLED)
+#define I2S_TDM_OUTPUT     (appconfI2S_ENABLED && (appconfI2S_MODE == appconfI2S_MODE_MASTER) && appconfI2S_TDM_ENABLED)
+#define I2S_SLAVE_OUTPUT   (appconfI2S_ENABLED && (appconfI2S_MODE == appconfI2S_MODE_SLAVE))
+
+/*
+ * Output taps. Each entry is a channel in audio_pipeline_output() order:
+ *   0 proc 0, AGC audio
+ *   1 proc 1, mic 1 audio with AEC applied
+ *   2 ref 0, overwritten by IC audio
+ *   3 ref 1, overwritten by NS audio
+ *   4 mic 0
+ *   5 mic 1
+ */
+#if I2S_MASTER_OUTPUT
+#define I2S_MASTER_CHANNELS (2)
+
+#if I2S_SRC_ENABLED
+static i2s_src_t i2s2_src;
+#endif
+
+/* Channel that carries a stage's output, for mic 0 or 1 */
+static uint32_t stage_output_channel(enum e_pipeline_processing_stages stage, int mic)
+{
+    switch (stage) {
+    case PIPELINE_STAGE_NONE: return mic ? 5 : 4;
+    case PIPELINE_STAGE_AEC:  return 1;
+    case PIPELINE_STAGE_IC:   return 2;
+    case PIPELINE_STAGE_NS:   return 3;
+    case PIPELINE_STAGE_AGC:
+    default:                  return 0;
+    }
+}
+
+/* The stages output on I2S can be changed by the configuration servicer, so the taps are made per frame */
+static void i2s_master_taps(output_router_tap_t *taps)
+{
+    taps[0] = (output_router_tap_t) OUTPUT_ROUTER_TAP(stage_output_channel(configuration_get_channel_0_stage(), 0));
+    taps[1] = (output_router_tap_t) OUTPUT_ROUTER_TAP(stage_output_channel(configuration_get_channel_1_stage(), 1));
+}
+#endif
+
+#if I2S_TDM_OUTPUT
+#define TDM_CHANNELS (appconfI2S_TDM_SLOTS)
+
+/* The slot map can be changed by the configuration servicer, so the taps are made per frame */
+static void tdm_slot_taps(output_router_tap_t *taps)
+{
+    uint8_t map[CONFIGURATION_SERVICER_TDM_SLOTS];
+
+    configuration_get_tdm_slot_map(map);
+    for (int i = 0; i < TDM_CHANNELS; i++) {
+        const uint8_t src = map[i] & ~CONFIGURATION_TDM_SLOT_TAG;
+        const int32_t tag = (map[i] & CONFIGURATION_TDM_SLOT_TAG) ? 0x1 : 0;
+
+        if (src == CONFIGURATION_TDM_SLOT_SILENT) {
+            taps[i] = (output_router_tap_t) OUTPUT_ROUTER_TAP_SILENT;
+        } else {
+            taps[i] = (output_router_tap_t) OUTPUT_ROUTER_TAP_MASKED(src, ~0x1, tag);
+        }
+    }
+}
+#endif
+
+#if I2S_SLAVE_OUTPUT
+/* ASR output is first */
+static const output_router_tap_t i2s_slave_taps[] = {
+    OUTPUT_ROUTER_TAP(0),
+    OUTPUT_ROUTER_TAP(1),
+};
+#define I2S_SLAVE_CHANNELS (sizeof(i2s_slave_taps) / sizeof(i2s_slave_taps[0]))
+#endif
+
+#if appconfUSB_ENABLED
+static const output_router_tap_t usb_taps[] = {
+    OUTPUT_ROUTER_TAP(0),
+    OUTPUT_ROUTER_TAP(1),
+    OUTPUT_ROUTER_TAP(2),
+    OUTPUT_ROUTER_TAP(3),
+    OUTPUT_ROUTER_TAP(4),
+    OUTPUT_ROUTER_TAP(5),
+};
+#define USB_CHANNELS (sizeof(usb_taps) / sizeof(usb_taps[0]))
+#endif
+
+#if appconfFEATURE_CACHE_ENABLED
+/* The feature cache reads the ASR channel */
+static const output_router_tap_t feature_taps[] = {
+    OUTPUT_ROUTER_TAP(0),
+};
+#define FEATURE_CHANNELS (sizeof(feature_taps) / sizeof(feature_taps[0]))
+#endif
+
+static uint32_t taps_channels(const output_router_tap_t *taps, size_t num_taps)
+{
+    uint32_t channels = 0;
+
+    for (size_t i = 0; i < num_taps; i++) {
+        /* A tap that masks out every bit, such as a silent one, does not read its channel */
+        if (taps[i].and_mask != 0) {
+            channels |= 1 << taps[i].src;
+        }
+    }
+    return channels;
+}
+
+uint32_t audio_pipeline_output_channels(void *output_app_data)
+{
+    (void) output_app_data;
+    uint32_t channels = 0;
+
+#if I2S_MASTER_OUTPUT
+    output_router_tap_t i2s_taps[I2S_MASTER_CHANNELS];
+    i2s_master_taps(i2s_taps);
+    channels |= taps_channels(i2s_taps, I2S_MASTER_CHANNELS);
+#endif
+#if I2S_TDM_OUTPUT
+    output_router_tap_t tdm_taps[TDM_CHANNELS];
+    tdm_slot_taps(tdm_taps);
+    channels |= taps_channels(tdm_taps, TDM_CHANNELS);
+#endif
+#if I2S_SLAVE_OUTPUT
+    channels |= taps_channels(i2s_slave_taps, I2S_SLAVE_CHANNELS);
+#endif
+#if appconfUSB_ENABLED
+    channels |= taps_channels(usb_taps, USB_CHANNELS);
+#endif
+#if appconfFEATURE_CACHE_ENABLED
+    channels |= taps_channels(feature_taps, FEATURE_CHANNELS);
+#endif
+
+    return channels;
+}
+
 int audio_pipeline_output(void *output_app_data,
                         int32_t **output_audio_frames,
                         size_t ch_count,
@@ -151,217 +388,106 @@ int audio_pipeline_output(void *output_app_data,
 {
     (void) output_app_data;
 
-#if appconfI2S_ENABLED
-#if appconfI2S_MODE == appconfI2S_MODE_MASTER
-#if !appconfI2S_TDM_ENABLED
+    /* The routes are resolved once per frame, then each output is a single pass over its channels */
+    const int32_t *frame = (const int32_t *) output_audio_frames;
+    output_route_t route;
+
     xassert(frame_count == appconfAUDIO_PIPELINE_FRAME_ADVANCE);
-    /* I2S expects sample channel format */
-    int32_t tmp[appconfAUDIO_PIPELINE_FRAME_ADVANCE][appconfAUDIO_PIPELINE_CHANNELS];
-    int32_t *tmpptr = (int32_t *)output_audio_frames;
-    for (int j=0; j<frame_count; j++) {
-        /* ASR output is first */
-        // tmp[j][0] = *(tmpptr+j);                    // proc 0, AGC audio
-        // tmp[j][1] = *(tmpptr+j+(1*frame_count))     // proc 1, mic 1 audio with AEC applied
-        // tmp[j][0] = *(tmpptr+j+(2*frame_count));    // ref 0, overwritten by IC audio
-        // tmp[j][1] = *(tmpptr+j+(3*frame_count));    // ref 1, overwritten by NS audio
-        // tmp[j][0] = *(tmpptr+j+(4*frame_count));    // mic 0
-        // tmp[j][1] = *(tmpptr+j+(5*frame_count));    // mic 1
-
-        enum e_pipeline_processing_stages channel_0_stage = configuration_get_channel_0_stage();
-        if (channel_0_stage == PIPELINE_STAGE_NONE) {
-            // Original microphone audio
-            tmp[j][0] = *(tmpptr + j + (4 * frame_count));
-        } else if (channel_0_stage == PIPELINE_STAGE_AEC) {
-            // AEC cancelled audio
-            tmp[j][0] = *(tmpptr + j + (1 * frame_count)); 
-        } else if (channel_0_stage == PIPELINE_STAGE_IC) {
-            // AEC+IC processed audio
-            tmp[j][0] = *(tmpptr + j + (2 * frame_count));
-        } else if (channel_0_stage == PIPELINE_STAGE_NS) {
-            // AEC+IC+NS processed audio
-            tmp[j][0] = *(tmpptr + j + (3 * frame_count));
-        } else if (channel_0_stage == PIPELINE_STAGE_AGC) {
-            // AEC+IC+NS+AGC processed audio
-            tmp[j][0] = *(tmpptr + j);
-        }
 
-        enum e_pipeline_processing_stages channel_1_stage = configuration_get_channel_1_stage();
-        if (channel_1_stage == PIPELINE_STAGE_NONE) {
-            // Original microphone audio
-            tmp[j][1] = *(tmpptr + j + (5 * frame_count));
-        } else if (channel_1_stage == PIPELINE_STAGE_AEC) {
-            // AEC cancelled audio
-            tmp[j][1] = *(tmpptr + j + (1 * frame_count)); 
-        } else if (channel_1_stage == PIPELINE_STAGE_IC) {
-            // AEC+IC processed audio
-            tmp[j][1] = *(tmpptr + j + (2 * frame_count));
-        } else if (channel_1_stage == PIPELINE_STAGE_NS) {
-            // AEC+IC+NS processed audio
-            tmp[j][1] = *(tmpptr + j + (3 * frame_count));
-        } else if (channel_1_stage == PIPELINE_STAGE_AGC) {
-            // AEC+IC+NS+AGC processed audio
-            tmp[j][1] = *(tmpptr + j);
-        }
-    }
+#if I2S_MASTER_OUTPUT
+    output_router_tap_t i2s_taps[I2S_MASTER_CHANNELS];
+    int32_t i2s_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][I2S_MASTER_CHANNELS];
+
+    i2s_master_taps(i2s_taps);
+    output_router_resolve(&route, i2s_taps, I2S_MASTER_CHANNELS, frame, frame_count);
+    output_router_interleave(&route, &i2s_frame[0][0], frame_count);
 
     // // TEST(jerry): output mic data on i2s1
     // rtos_i2s_tx(i2s1_ctx,
-    //             (int32_t*) tmp,
+    //             (int32_t*) i2s_frame,
     //             frame_count,
     //             portMAX_DELAY);
-    
+
     // TEST(jerry): output mic data on i2s2
+#if I2S_SRC_ENABLED
+    int32_t i2s_tx_frame[I2S_SRC_FACTOR * appconfAUDIO_PIPELINE_FRAME_ADVANCE][I2S_MASTER_CHANNELS];
+
+    i2s_src_upsample(&i2s2_src, i2s_tx_frame, i2s_frame, frame_count);
     rtos_i2s_tx(i2s2_ctx,
-                (int32_t*) tmp,
-                frame_count,
+                (int32_t*) i2s_tx_frame,
+                I2S_SRC_FACTOR * frame_count,
                 portMAX_DELAY);
 #else
-    int32_t *tmpptr = (int32_t *)output_audio_frames;
-    for (int i = 0; i < frame_count; i++) {
-        /* output_audio_frames format is
-         *   processed_audio_frame
-         *   reference_audio_frame
-         *   raw_mic_audio_frame
-         */
-        int32_t tdm_output[6];
+    rtos_i2s_tx(i2s2_ctx,
+                (int32_t*) i2s_frame,
+                frame_count,
+                portMAX_DELAY);
+#endif
+#endif
 
-        tdm_output[0] = *(tmpptr + i + (4 * frame_count)) & ~0x1;   // mic 0
-        tdm_output[1] = *(tmpptr + i + (5 * frame_count)) & ~0x1;   // mic 1
-        tdm_output[2] = *(tmpptr + i + (2 * frame_count)) & ~0x1;   // ref 0
-        tdm_output[3] = *(tmpptr + i + (3 * frame_count)) & ~0x1;   // ref 1
-        tdm_output[4] = *(tmpptr + i) | 0x1;                        // proc 0
-        tdm_output[5] = *(tmpptr + i + frame_count) | 0x1;          // proc 1
+#if I2S_TDM_OUTPUT
+    /* Each sample period carries the slots as stereo I2S frames, so the whole frame goes in one call */
+    static int32_t tdm_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][TDM_CHANNELS];
+    output_router_tap_t tdm_taps[TDM_CHANNELS];
 
-        rtos_i2s_tx(i2s1_ctx,
-                    tdm_output,
-                    appconfI2S_AUDIO_SAMPLE_RATE / appconfAUDIO_PIPELINE_SAMPLE_RATE,
-                    portMAX_DELAY);
-    }
+    tdm_slot_taps(tdm_taps);
+    output_router_resolve(&route, tdm_taps, TDM_CHANNELS, frame, frame_count);
+    output_router_interleave(&route, &tdm_frame[0][0], frame_count);
+
+    rtos_i2s_tx(i2s1_ctx,
+                &tdm_frame[0][0],
+                frame_count * appconfI2S_SRC_FACTOR,
+                portMAX_DELAY);
 #endif
-#elif appconfI2S_MODE == appconfI2S_MODE_SLAVE
+
+#if I2S_SLAVE_OUTPUT
     /* I2S expects sample channel format */
-    int32_t tmp[appconfAUDIO_PIPELINE_FRAME_ADVANCE][appconfAUDIO_PIPELINE_CHANNELS];
-    int32_t *tmpptr = (int32_t *)output_audio_frames;
-    for (int j=0; j<appconfAUDIO_PIPELINE_FRAME_ADVANCE; j++) {
-        /* ASR output is first */
-        tmp[j][0] = *(tmpptr+j);
-        tmp[j][1] = *(tmpptr+j+appconfAUDIO_PIPELINE_FRAME_ADVANCE);
-    }
+    int32_t i2s_frame[appconfAUDIO_PIPELINE_FRAME_ADVANCE][I2S_SLAVE_CHANNELS];
+
+    output_router_resolve(&route, i2s_slave_taps, I2S_SLAVE_CHANNELS, frame, frame_count);
+    output_router_interleave(&route, &i2s_frame[0][0], frame_count);
 
     rtos_intertile_tx(intertile_ctx,
                       appconfI2S_OUTPUT_SLAVE_PORT,
-                      tmp,
-                      sizeof(tmp));
-#endif
+                      i2s_frame,
+                      sizeof(i2s_frame));
 #endif
 
 #if appconfUSB_ENABLED
+    /* Only used if usb_taps stops passing the frame straight through */
+    static int32_t usb_frame[USB_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
+
+    output_router_resolve(&route, usb_taps, USB_CHANNELS, frame, frame_count);
     usb_audio_send(intertile_usb_audio_ctx,
                 frame_count,
-                output_audio_frames,
-                6);
-#endif
-
-#if appconfWW_ENABLED
-    ww_audio_send(intertile_ctx,
-                  frame_count,
-                  (int32_t(*)[2])output_audio_frames);
+                (int32_t **) output_router_planar(&route, &usb_frame[0][0], frame_count),
+                USB_CHANNELS);
 #endif
 
-    return AUDIO_PIPELINE_FREE_FRAME;
-}
-
-RTOS_I2S_APP_SEND_FILTER_CALLBACK_ATTR
-size_t i2s_send_upsample_cb(rtos_i2s_t *ctx, void *app_data, int32_t *i2s_frame, size_t i2s_frame_size, int32_t *send_buf, size_t samples_available)
-{
-    static int i;
-    static int32_t src_data[2][SRC_FF3V_FIR_TAPS_PER_PHASE] __attribute__((aligned(8)));
+#if appconfFEATURE_CACHE_ENABLED
+    /* Only used if feature_taps stops passing the ASR channel straight through */
+    static int32_t feature_frame[FEATURE_CHANNELS][appconfAUDIO_PIPELINE_FRAME_ADVANCE];
 
-    xassert(i2s_frame_size == 2);
+    output_router_resolve(&route, feature_taps, FEATURE_CHANNELS, frame, frame_count);
+    feature_cache_push(output_router_planar(&route, &feature_frame[0][0], frame_count), 1, frame_count);
+#endif
 
-    i2s_frame[0] = send_buf[0];
-    i2s_frame[1] = send_buf[1];
+    /* Unused if no outputs are enabled */
+    (void) frame;
+    (void) route;
 
-    switch (i) {
-    case 0:
-        i = 1;
-        if (samples_available >= 2) {
-            // i2s_frame[0] = src_us3_voice_input_sample(src_data[0], src_ff3v_fir_coefs[2], send_buf[0]);
-            // i2s_frame[1] = src_us3_voice_input_sample(src_data[1], src_ff3v_fir_coefs[2], send_buf[1]);
-            return 2;
-        } else {
-            // i2s_frame[0] = src_us3_voice_input_sample(src_data[0], src_ff3v_fir_coefs[2], 0);
-            // i2s_frame[1] = src_us3_voice_input_sample(src_data[1], src_ff3v_fir_coefs[2], 0);
-            return 0;
-        }
-    case 1:
-        i = 2;
-        // i2s_frame[0] = src_us3_voice_get_next_sample(src_data[0], src_ff3v_fir_coefs[1]);
-        // i2s_frame[1] = src_us3_voice_get_next_sample(src_data[1], src_ff3v_fir_coefs[1]);
-        return 0;
-    case 2:
-        i = 0;
-        // i2s_frame[0] = src_us3_voice_get_next_sample(src_data[0], src_ff3v_fir_coefs[0]);
-        // i2s_frame[1] = src_us3_voice_get_next_sample(src_data[1], src_ff3v_fir_coefs[0]);
-        return 0;
-    default:
-        xassert(0);
-        return 0;
-    }
+    return AUDIO_PIPELINE_FREE_FRAME;
 }
 
-RTOS_I2S_APP_RECEIVE_FILTER_CALLBACK_ATTR
-size_t i2s_send_downsample_cb(rtos_i2s_t *ctx, void *app_data, int32_t *i2s_frame, size_t i2s_frame_size, int32_t *receive_buf, size_t sample_spaces_free)
+#if appconfWW_ENABLED
+void ww_model_runner_result(float score, int detected)
 {
-    static int i;
-    static int64_t sum[2];
-    static int32_t src_data[2][SRC_FF3V_FIR_NUM_PHASES][SRC_FF3V_FIR_TAPS_PER_PHASE] __attribute__((aligned (8)));
-
-    xassert(i2s_frame_size == 2);
-
-    switch (i) {
-    case 0:
-        i = 1;
-        sum[0] = src_ds3_voice_add_sample(0, src_data[0][0], src_ff3v_fir_coefs[0], i2s_frame[0]);
-        sum[1] = src_ds3_voice_add_sample(0, src_data[1][0], src_ff3v_fir_coefs[0], i2s_frame[1]);
-        return 0;
-    case 1:
-        i = 2;
-        sum[0] = src_ds3_voice_add_sample(sum[0], src_data[0][1], src_ff3v_fir_coefs[1], i2s_frame[0]);
-        sum[1] = src_ds3_voice_add_sample(sum[1], src_data[1][1], src_ff3v_fir_coefs[1], i2s_frame[1]);
-        return 0;
-    case 2:
-        i = 0;
-        if (sample_spaces_free >= 2) {
-            receive_buf[0] = src_ds3_voice_add_final_sample(sum[0], src_data[0][2], src_ff3v_fir_coefs[2], i2s_frame[0]);
-            receive_buf[1] = src_ds3_voice_add_final_sample(sum[1], src_data[1][2], src_ff3v_fir_coefs[2], i2s_frame[1]);
-            return 2;
-        } else {
-            (void) src_ds3_voice_add_final_sample(sum[0], src_data[0][2], src_ff3v_fir_coefs[2], i2s_frame[0]);
-            (void) src_ds3_voice_add_final_sample(sum[1], src_data[1][2], src_ff3v_fir_coefs[2], i2s_frame[1]);
-            return 0;
-        }
-    default:
-        xassert(0);
-        return 0;
+    configuration_push_ww_score((int)(score * 100), detected);
+    if (detected) {
+        rtos_printf("wake word detected, score %d\n", (int)(score * 100));
     }
 }
-
-void i2s_rate_conversion_enable(void)
-{
-#if !appconfI2S_TDM_ENABLED
-    rtos_i2s_send_filter_cb_set(i2s1_ctx, i2s_send_upsample_cb, NULL);
 #endif
-    rtos_i2s_receive_filter_cb_set(i2s1_ctx, i2s_send_downsample_cb, NULL);
-}
-
-void i2s2_rate_conversion_enable(void)
-{
-#if !appconfI2S_TDM_ENABLED
-    rtos_i2s_send_filter_cb_set(i2s2_ctx, i2s_send_upsample_cb, NULL);
-#endif
-    rtos_i2s_receive_filter_cb_set(i2s2_ctx, i2s_send_downsample_cb, NULL);
-}
 
 void vApplicationMallocFailedHook(void)
 {
@@ -374,6 +500,7 @@ static void mem_analysis(void)
 {
 	for (;;) {
 		rtos_printf("Tile[%d]:\n\tMinimum heap free: %d\n\tCurrent heap free: %d\n", THIS_XCORE_TILE, xPortGetMinimumEverFreeHeapSize(), xPortGetFreeHeapSize());
+		frame_pool_print_stats();
 		vTaskDelay(pdMS_TO_TICKS(5000));
 	}
 }
@@ -384,6 +511,12 @@ void startup_task(void *arg)
 
     platform_start();
 
+#if appconfHOST_EVENTS_ENABLED && ON_TILE(HOST_EVENTS_TILE_NO)
+    host_events_init();
+    /* Reports changes of the mute switch */
+    gpio_test(gpio_ctx_t0);
+#endif
+
 #if ON_TILE(1) && appconfI2S_ENABLED && (appconfI2S_MODE == appconfI2S_MODE_SLAVE)
     xTaskCreate((TaskFunction_t) i2s_slave_intertile,
                 "i2s_slave_intertile",
@@ -393,6 +526,11 @@ void startup_task(void *arg)
                 NULL);
 #endif
 
+#if ON_TILE(FLASH_TILE_NO)
+    /* Before the servicer can change them and the pipeline starts with them */
+    configuration_restore();
+#endif
+
 #if appconfI2C_DFU_ENABLED && ON_TILE(I2C_CTRL_TILE_NO)
     servicer_t servicer_cfg;
     configuration_servicer_init(&servicer_cfg);
@@ -428,6 +566,10 @@ void startup_task(void *arg)
     rtos_qspi_flash_fast_read_setup_ll(qspi_flash_ctx);
 #endif
 
+#if appconfFEATURE_CACHE_ENABLED && ON_TILE(FEATURE_CACHE_TILE_NO)
+    feature_cache_init();
+#endif
+
 #if appconfWW_ENABLED && ON_TILE(WW_TILE_NO)
     ww_task_create(appconfWW_TASK_PRIORITY);
 #endif
@@ -0,0 +1,70 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <string.h>
+#include <xassert.h>
+
+#include "output_router.h"
+
+void output_router_resolve(output_route_t *route,
+                           const output_router_tap_t *taps,
+                           size_t num_channels,
+                           const int32_t *frame,
+                           size_t frame_count)
+{
+    int pass_through = 1;
+
+    xassert(num_channels <= OUTPUT_ROUTER_MAX_CHANNELS);
+
+    route->num_channels = num_channels;
+    for (size_t ch = 0; ch < num_channels; ch++) {
+        route->src[ch] = frame + (taps[ch].src * frame_count);
+        route->and_mask[ch] = taps[ch].and_mask;
+        route->or_mask[ch] = taps[ch].or_mask;
+
+        if (taps[ch].src != ch || taps[ch].and_mask != ~0 || taps[ch].or_mask != 0) {
+            pass_through = 0;
+        }
+    }
+    route->frame = pass_through ? frame : NULL;
+}
+
+void output_router_interleave(const output_route_t *route,
+                              int32_t *dst,
+                              size_t frame_count)
+{
+    const size_t n = route->num_channels;
+
+    /* One channel at a time, so the inner loop has no branches or calls */
+    for (size_t ch = 0; ch < n; ch++) {
+        const int32_t *src = route->src[ch];
+        const int32_t and_mask = route->and_mask[ch];
+        const int32_t or_mask = route->or_mask[ch];
+        int32_t *out = dst + ch;
+
+        for (size_t i = 0; i < frame_count; i++) {
+            out[i * n] = (src[i] & and_mask) | or_mask;
+        }
+    }
+}
+
+const int32_t *output_router_planar(const output_route_t *route,
+                                    int32_t *scratch,
+                                    size_t frame_count)
+{
+    if (route->frame != NULL) {
+        return route->frame;
+    }
+
+    for (size_t ch = 0; ch < route->num_channels; ch++) {
+        const int32_t *src = route->src[ch];
+        const int32_t and_mask = route->and_mask[ch];
+        const int32_t or_mask = route->or_mask[ch];
+        int32_t *out = scratch + (ch * frame_count);
+
+        for (size_t i = 0; i < frame_count; i++) {
+            out[i] = (src[i] & and_mask) | or_mask;
+        }
+    }
+    return scratch;
+}
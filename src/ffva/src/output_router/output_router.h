@@ -0,0 +1,64 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef OUTPUT_ROUTER_H_
+#define OUTPUT_ROUTER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Most channels one output can carry, as in a 16 slot TDM frame */
+#define OUTPUT_ROUTER_MAX_CHANNELS  (16)
+
+/*
+ * One channel of an output: a channel of the pipeline output frame, in
+ * audio_pipeline_output() order. Each sample is written as
+ * (sample & and_mask) | or_mask, which lets TDM tag processed audio in
+ * bit 0.
+ */
+typedef struct {
+    uint8_t src;
+    int32_t and_mask;
+    int32_t or_mask;
+} output_router_tap_t;
+
+#define OUTPUT_ROUTER_TAP(ch)               { .src = (ch), .and_mask = ~0, .or_mask = 0 }
+#define OUTPUT_ROUTER_TAP_MASKED(ch, a, o)  { .src = (ch), .and_mask = (a), .or_mask = (o) }
+#define OUTPUT_ROUTER_TAP_SILENT            { .src = 0, .and_mask = 0, .or_mask = 0 }
+
+/* An output's taps resolved against one frame */
+typedef struct {
+    size_t num_channels;
+    const int32_t *src[OUTPUT_ROUTER_MAX_CHANNELS];
+    int32_t and_mask[OUTPUT_ROUTER_MAX_CHANNELS];
+    int32_t or_mask[OUTPUT_ROUTER_MAX_CHANNELS];
+    const int32_t *frame;   /* Set if the taps are the frame's channels in order, unmasked */
+} output_route_t;
+
+/**
+ * Resolves taps against a frame. Called once per frame, before any of the
+ * functions below.
+ *
+ * \param frame         The pipeline output, frame_count samples per channel
+ */
+void output_router_resolve(output_route_t *route,
+                           const output_router_tap_t *taps,
+                           size_t num_channels,
+                           const int32_t *frame,
+                           size_t frame_count);
+
+/* Writes frame_count samples of each channel to dst, sample channel format */
+void output_router_interleave(const output_route_t *route,
+                              int32_t *dst,
+                              size_t frame_count);
+
+/**
+ * Returns the routed channels in channel sample format. This is the frame
+ * itself when the route passes it through, otherwise the channels are
+ * copied to scratch, which must hold num_channels * frame_count samples.
+ */
+const int32_t *output_router_planar(const output_route_t *route,
+                                    int32_t *scratch,
+                                    size_t frame_count);
+
+#endif /* OUTPUT_ROUTER_H_ */
@@ -0,0 +1,142 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#include <string.h>
+#include <xassert.h>
+
+#include "ref_asrc.h"
+
+/*
+ * Pulls for the fill level to settle after a step in the rate. The
+ * integral term is a quarter as fast, which keeps the loop from
+ * overshooting. At 720 frames a pull this is about 2 seconds, and locks
+ * onto clock offsets of up to 1000 ppm without running dry.
+ */
+#define REF_ASRC_LOOP_PULLS     (128)
+
+static void fifo_write(ref_asrc_t *ctx, int32_t (*src)[REF_ASRC_CHANNELS], size_t n)
+{
+    size_t write_index = ctx->read_index + ctx->fill;
+    if (write_index >= ctx->fifo_frames) {
+        write_index -= ctx->fifo_frames;
+    }
+
+    size_t first = ctx->fifo_frames - write_index;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(ctx->fifo[write_index], src, first * sizeof(src[0]));
+    memcpy(ctx->fifo[0], src[first], (n - first) * sizeof(src[0]));
+    ctx->fill += n;
+}
+
+static void fifo_skip(ref_asrc_t *ctx, size_t n)
+{
+    ctx->read_index += n;
+    if (ctx->read_index >= ctx->fifo_frames) {
+        ctx->read_index -= ctx->fifo_frames;
+    }
+    ctx->fill -= n;
+}
+
+static void fifo_read(ref_asrc_t *ctx, int32_t (*dst)[REF_ASRC_CHANNELS], size_t n)
+{
+    size_t first = ctx->fifo_frames - ctx->read_index;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(dst, ctx->fifo[ctx->read_index], first * sizeof(dst[0]));
+    memcpy(dst[first], ctx->fifo[0], (n - first) * sizeof(dst[0]));
+    fifo_skip(ctx, n);
+}
+
+/* Drops the buffered output and waits to fill up to the target again. The rate estimate is kept. */
+static void restart_lock(ref_asrc_t *ctx)
+{
+    ctx->read_index = 0;
+    ctx->fill = 0;
+    ctx->locked = 0;
+    ctx->correction = 0;
+    ctx->xruns++;
+}
+
+static uint64_t fs_ratio(const ref_asrc_t *ctx)
+{
+    return ctx->nominal_ratio + (int64_t)((float)ctx->nominal_ratio * (ctx->rate + ctx->correction));
+}
+
+void ref_asrc_init(ref_asrc_t *ctx,
+                   fs_code_t fs_code,
+                   int32_t (*fifo)[REF_ASRC_CHANNELS],
+                   size_t fifo_frames,
+                   size_t pull_frames)
+{
+    xassert(fifo_frames >= pull_frames + 4 * REF_ASRC_TARGET_FRAMES);
+
+    memset(ctx, 0, sizeof(*ctx));
+
+    for (int ch = 0; ch < REF_ASRC_CHANNELS; ch++) {
+        ctx->ctrl[ch].psState = &ctx->state[ch];
+        ctx->ctrl[ch].piStack = ctx->stack[ch];
+        ctx->ctrl[ch].piADCoefs = ctx->adfir_coefs.iASRCADFIRCoefs;
+    }
+    ctx->nominal_ratio = asrc_init(fs_code, fs_code, ctx->ctrl, REF_ASRC_CHANNELS, REF_ASRC_BLOCK_FRAMES, OFF);
+
+    ctx->fifo = fifo;
+    ctx->fifo_frames = fifo_frames;
+    ctx->pull_frames = pull_frames;
+}
+
+void ref_asrc_push(ref_asrc_t *ctx, int32_t (*in)[REF_ASRC_CHANNELS])
+{
+    int32_t out[REF_ASRC_BLOCK_OUT_FRAMES][REF_ASRC_CHANNELS];
+
+    size_t n = asrc_process((int *) in, (int *) out, fs_ratio(ctx), ctx->ctrl);
+
+    if (ctx->fill + n > ctx->fifo_frames) {
+        if (ctx->locked) {
+            restart_lock(ctx);
+        } else {
+            /* Still filling up, only the newest frames are needed */
+            fifo_skip(ctx, ctx->fill + n - ctx->fifo_frames);
+        }
+    }
+    fifo_write(ctx, out, n);
+}
+
+void ref_asrc_pull(ref_asrc_t *ctx, int32_t (*out)[REF_ASRC_CHANNELS])
+{
+    const size_t n = ctx->pull_frames;
+
+    if (!ctx->locked) {
+        if (ctx->fill < n + REF_ASRC_TARGET_FRAMES) {
+            memset(out, 0, n * sizeof(out[0]));
+            return;
+        }
+        /* Start on the newest frames, so that the target is left after this pull */
+        fifo_skip(ctx, ctx->fill - (n + REF_ASRC_TARGET_FRAMES));
+        ctx->locked = 1;
+    }
+
+    if (ctx->fill < n) {
+        memset(out, 0, n * sizeof(out[0]));
+        restart_lock(ctx);
+        return;
+    }
+    fifo_read(ctx, out, n);
+
+    /* More input than output leaves more behind, so the ratio goes up to consume it faster */
+    const float kp = 1.0f / ((float) n * REF_ASRC_LOOP_PULLS);
+    const float ki = kp / (4 * REF_ASRC_LOOP_PULLS);
+    const float err = (float) ctx->fill - REF_ASRC_TARGET_FRAMES;
+
+    ctx->rate += ki * err;
+    ctx->correction = kp * err;
+}
+
+void ref_asrc_get_status(const ref_asrc_t *ctx, ref_asrc_status_t *status)
+{
+    status->rate_ppb = (int32_t)(ctx->rate * 1e9f);
+    status->fill = ctx->fill;
+    status->xruns = ctx->xruns;
+}
@@ -0,0 +1,92 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef REF_ASRC_H_
+#define REF_ASRC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "src.h"
+
+/* Channels per reference frame */
+#define REF_ASRC_CHANNELS       (2)
+
+/* Input frames per asrc_process() call */
+#define REF_ASRC_BLOCK_FRAMES   (8)
+
+/* Output frames the ASRC may produce from one block */
+#define REF_ASRC_BLOCK_OUT_FRAMES   (REF_ASRC_BLOCK_FRAMES * ASRC_N_OUT_IN_RATIO_MAX)
+
+/*
+ * Output frames held after each pull once locked. Must cover the
+ * jitter in when the input arrives, which is at least a block.
+ */
+#define REF_ASRC_TARGET_FRAMES  (128)
+
+/*
+ * Rate converter between a reference with its own clock and the
+ * pipeline. The input is pushed a block at a time as it arrives, and the
+ * output pulled a pipeline frame at a time on the mic clock. The rate
+ * ratio is steered to hold the frames left between pulls at
+ * REF_ASRC_TARGET_FRAMES. Both ends run at the same nominal rate.
+ *
+ * Push and pull must be called from the same task.
+ */
+typedef struct {
+    asrc_state_t state[REF_ASRC_CHANNELS];
+    int stack[REF_ASRC_CHANNELS][ASRC_STACK_LENGTH_MULT * REF_ASRC_BLOCK_FRAMES];
+    asrc_ctrl_t ctrl[REF_ASRC_CHANNELS];
+    asrc_adfir_coefs_t adfir_coefs;
+
+    uint64_t nominal_ratio;
+    float rate;         /* Input rate over output rate, less 1 */
+    float correction;   /* Rate offset, on top of rate, that pulls the fill level back to target */
+
+    int32_t (*fifo)[REF_ASRC_CHANNELS];
+    size_t fifo_frames;
+    size_t read_index;
+    size_t fill;
+    size_t pull_frames;
+    int locked;
+    uint32_t xruns;
+} ref_asrc_t;
+
+typedef struct {
+    int32_t rate_ppb;   /* Reference clock offset from the mic clock, in parts per billion */
+    uint32_t fill;      /* Output frames held after the last pull */
+    uint32_t xruns;     /* Times the output ran dry or overflowed, each restarts the lock */
+} ref_asrc_status_t;
+
+/**
+ * Initialises the converter for a sample rate of fs_code.
+ *
+ * \param fifo          output buffer, at least pull_frames + 4 * REF_ASRC_TARGET_FRAMES
+ * \param fifo_frames   frames in fifo
+ * \param pull_frames   frames taken by each ref_asrc_pull()
+ */
+void ref_asrc_init(ref_asrc_t *ctx,
+                   fs_code_t fs_code,
+                   int32_t (*fifo)[REF_ASRC_CHANNELS],
+                   size_t fifo_frames,
+                   size_t pull_frames);
+
+/**
+ * Converts REF_ASRC_BLOCK_FRAMES input frames, in sample channel format.
+ * If the buffer is full, it is emptied and the lock restarted.
+ */
+void ref_asrc_push(ref_asrc_t *ctx, int32_t (*in)[REF_ASRC_CHANNELS]);
+
+/**
+ * Takes pull_frames output frames, in sample channel format, and updates
+ * the rate ratio. Until the buffer holds a frame plus the target, and after
+ * it runs dry, the output is zero.
+ */
+void ref_asrc_pull(ref_asrc_t *ctx, int32_t (*out)[REF_ASRC_CHANNELS]);
+
+/**
+ * Returns the rate estimate and the buffer fill level. Must be called from
+ * the task that calls ref_asrc_pull().
+ */
+void ref_asrc_get_status(const ref_asrc_t *ctx, ref_asrc_status_t *status);
+
+#endif /* REF_ASRC_H_ */
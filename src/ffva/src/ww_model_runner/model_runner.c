@@ -7,37 +7,101 @@
 
 #include "FreeRTOS.h"
 #include "task.h"
-#include "stream_buffer.h"
 
 #include "app_conf.h"
 #include "platform/driver_instances.h"
+#include "feature_cache/feature_cache.h"
 #include "ww_model_runner/ww_model_runner.h"
+#include "ww_model_runner/ww_inference.h"
 
-configSTACK_DEPTH_TYPE model_runner_manager_stack_size = 287;
+#if appconfWW_ENABLED
+
+/* Generated by ffva.cmake from FFVA_WW_MODEL. ww_model_size is 0 if no model was given */
+extern const uint8_t ww_model[];
+extern const size_t ww_model_size;
+
+/*
+ * TFLite Micro calls its kernels through function pointers, so the tools
+ * cannot size this stack. This covers the operators ww_inference registers.
+ */
+configSTACK_DEPTH_TYPE model_runner_manager_stack_size = 1024;
+
+/* Returns 0 if the model is loaded and ready to run */
+static int model_runner_init(void)
+{
+    if (ww_model_size == 0) {
+        rtos_printf("no wake word model, build with FFVA_WW_MODEL set\n");
+        return -1;
+    }
+
+    /* The arena is kept for the life of the task */
+    uint8_t *arena = pvPortMalloc(appconfWW_TENSOR_ARENA_BYTES);
+    if (arena == NULL) {
+        rtos_printf("no memory for the wake word tensor arena\n");
+        return -1;
+    }
+
+    if (ww_inference_init(ww_model, arena, appconfWW_TENSOR_ARENA_BYTES) != 0) {
+        rtos_printf("wake word model not supported or arena too small\n");
+        vPortFree(arena);
+        return -1;
+    }
+
+    rtos_printf("wake word model: %d frame window, arena %u of %u bytes\n",
+                ww_inference_frames(),
+                (unsigned) ww_inference_arena_used(),
+                (unsigned) appconfWW_TENSOR_ARENA_BYTES);
+    return 0;
+}
 
 void model_runner_manager(void *args)
 {
-    StreamBufferHandle_t input_queue = (StreamBufferHandle_t)args;
+    (void) args;
 
-    int16_t buf[appconfWW_FRAMES_PER_INFERENCE];
+    static feature_frame_t frame;
+    int hops = 0;
+    int holdoff = 0;
 
-    /* Perform any initialization here */
+    /* Without a model the task ends, the feature cache does not wait for its readers */
+    if (model_runner_init() != 0) {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    uint32_t index = feature_cache_attach();
 
     while (1)
     {
-        /* Receive audio frames */
-        uint8_t *buf_ptr = (uint8_t*)buf;
-        size_t buf_len = appconfWW_FRAMES_PER_INFERENCE * sizeof(int16_t);
-        do {
-            size_t bytes_rxed = xStreamBufferReceive(input_queue,
-                                                     buf_ptr,
-                                                     buf_len,
-                                                     portMAX_DELAY);
-            buf_len -= bytes_rxed;
-            buf_ptr += bytes_rxed;
-        } while(buf_len > 0);
-
-        /* Perform inference here */
-        // rtos_printf("inference\n");
+        /* Features are made once per hop in the output path, so this only ever waits on the model */
+        feature_cache_read(index, &frame);
+        if (frame.index != index) {
+            rtos_printf("wake word model fell %u frames behind\n", (unsigned) (frame.index - index));
+        }
+        index = frame.index + 1;
+
+        ww_inference_push(frame.mel);
+
+        if (holdoff > 0) {
+            holdoff--;
+        }
+        if (++hops < appconfWW_HOPS_PER_INFERENCE) {
+            continue;
+        }
+        hops = 0;
+
+        float score;
+        if (ww_inference_invoke(&score) != 0) {
+            rtos_printf("wake word inference failed\n");
+            continue;
+        }
+
+        int detected = 0;
+        if (holdoff == 0 && score * 100 >= appconfWW_DETECT_THRESHOLD) {
+            detected = 1;
+            holdoff = appconfWW_DETECT_HOLDOFF_HOPS;
+        }
+        ww_model_runner_result(score, detected);
     }
 }
+
+#endif /* appconfWW_ENABLED */
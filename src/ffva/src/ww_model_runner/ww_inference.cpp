@@ -0,0 +1,159 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/*
+ * appconfWW_ENABLED is only set from the build, app_conf.h just defaults it
+ * to 0, so it is tested here without pulling the RTOS headers into C++.
+ */
+#if defined(appconfWW_ENABLED) && appconfWW_ENABLED
+
+#include <new>
+#include <math.h>
+#include <string.h>
+
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+#include "feature_cache/feature_frontend.h"
+#include "ww_model_runner/ww_inference.h"
+
+/* Operators registered below */
+#define WW_INFERENCE_OPS    (12)
+
+typedef tflite::MicroMutableOpResolver<WW_INFERENCE_OPS> ww_op_resolver_t;
+
+/* Both are built in place by ww_inference_init(), so nothing is allocated from the heap */
+alignas(ww_op_resolver_t) static uint8_t op_resolver_storage[sizeof(ww_op_resolver_t)];
+alignas(tflite::MicroInterpreter) static uint8_t interpreter_storage[sizeof(tflite::MicroInterpreter)];
+
+static ww_op_resolver_t *op_resolver = nullptr;
+static tflite::MicroInterpreter *interpreter = nullptr;
+static int input_frames = 0;
+
+/* The operators used by common keyword spotting models, such as DS-CNN and the TFLite Micro micro_speech example */
+static void add_ops(ww_op_resolver_t *resolver)
+{
+    resolver->AddConv2D();
+    resolver->AddDepthwiseConv2D();
+    resolver->AddFullyConnected();
+    resolver->AddAveragePool2D();
+    resolver->AddMaxPool2D();
+    resolver->AddMean();
+    resolver->AddRelu();
+    resolver->AddReshape();
+    resolver->AddSoftmax();
+    resolver->AddLogistic();
+    resolver->AddQuantize();
+    resolver->AddDequantize();
+}
+
+int ww_inference_init(const uint8_t *model_data, uint8_t *arena, size_t arena_size)
+{
+    if (interpreter != nullptr) {
+        interpreter->~MicroInterpreter();
+        interpreter = nullptr;
+    }
+
+    const tflite::Model *model = tflite::GetModel(model_data);
+    if (model->version() != TFLITE_SCHEMA_VERSION) {
+        return -1;
+    }
+
+    if (op_resolver == nullptr) {
+        op_resolver = new (op_resolver_storage) ww_op_resolver_t();
+        add_ops(op_resolver);
+    }
+
+    interpreter = new (interpreter_storage) tflite::MicroInterpreter(model, *op_resolver, arena, arena_size);
+    if (interpreter->AllocateTensors() != kTfLiteOk) {
+        return -1;
+    }
+
+    const TfLiteTensor *input = interpreter->input(0);
+    const TfLiteTensor *output = interpreter->output(0);
+    if (input == nullptr || output == nullptr) {
+        return -1;
+    }
+    if (input->type != kTfLiteInt8 && input->type != kTfLiteFloat32) {
+        return -1;
+    }
+    if (output->type != kTfLiteInt8 && output->type != kTfLiteUInt8 && output->type != kTfLiteFloat32) {
+        return -1;
+    }
+
+    size_t input_elements = input->bytes / (input->type == kTfLiteInt8 ? sizeof(int8_t) : sizeof(float));
+    if (input_elements == 0 || input_elements % FEATURE_FRONTEND_MEL_BANDS != 0) {
+        return -1;
+    }
+    input_frames = input_elements / FEATURE_FRONTEND_MEL_BANDS;
+
+    /* Start from a window of silence */
+    float silence[FEATURE_FRONTEND_MEL_BANDS];
+    for (int b = 0; b < FEATURE_FRONTEND_MEL_BANDS; b++) {
+        silence[b] = logf(1e-6f);
+    }
+    for (int i = 0; i < input_frames; i++) {
+        ww_inference_push(silence);
+    }
+
+    return 0;
+}
+
+int ww_inference_frames(void)
+{
+    return input_frames;
+}
+
+size_t ww_inference_arena_used(void)
+{
+    return interpreter != nullptr ? interpreter->arena_used_bytes() : 0;
+}
+
+void ww_inference_push(const float *features)
+{
+    TfLiteTensor *input = interpreter->input(0);
+    const size_t newest = (input_frames - 1) * FEATURE_FRONTEND_MEL_BANDS;
+
+    if (input->type == kTfLiteInt8) {
+        int8_t *dst = input->data.int8;
+        memmove(dst, &dst[FEATURE_FRONTEND_MEL_BANDS], newest * sizeof(int8_t));
+        for (int b = 0; b < FEATURE_FRONTEND_MEL_BANDS; b++) {
+            int32_t q = (int32_t) lroundf(features[b] / input->params.scale) + input->params.zero_point;
+            if (q > INT8_MAX) q = INT8_MAX;
+            if (q < INT8_MIN) q = INT8_MIN;
+            dst[newest + b] = (int8_t) q;
+        }
+    } else {
+        float *dst = input->data.f;
+        memmove(dst, &dst[FEATURE_FRONTEND_MEL_BANDS], newest * sizeof(float));
+        memcpy(&dst[newest], features, FEATURE_FRONTEND_MEL_BANDS * sizeof(float));
+    }
+}
+
+int ww_inference_invoke(float *score)
+{
+    if (interpreter->Invoke() != kTfLiteOk) {
+        return -1;
+    }
+
+    const TfLiteTensor *output = interpreter->output(0);
+    float value;
+
+    if (output->type == kTfLiteInt8) {
+        int8_t q = output->data.int8[output->bytes - 1];
+        value = (q - output->params.zero_point) * output->params.scale;
+    } else if (output->type == kTfLiteUInt8) {
+        uint8_t q = output->data.uint8[output->bytes - 1];
+        value = (q - output->params.zero_point) * output->params.scale;
+    } else {
+        value = output->data.f[output->bytes / sizeof(float) - 1];
+    }
+
+    if (value > 1.0f) value = 1.0f;
+    if (value < 0.0f) value = 0.0f;
+    *score = value;
+    return 0;
+}
+
+#endif /* appconfWW_ENABLED */
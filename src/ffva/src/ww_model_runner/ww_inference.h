@@ -0,0 +1,67 @@
+// Copyright 2023 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#ifndef WW_INFERENCE_H_
+#define WW_INFERENCE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * TensorFlow Lite Micro interpreter for the wake word model. There is one
+ * instance, set up once at start up with the arena it keeps for its
+ * lifetime; nothing is allocated after ww_inference_init().
+ *
+ * The model input is a window of feature frames, oldest first, of
+ * FEATURE_FRONTEND_MEL_BANDS values each. Any shape whose element count is a
+ * multiple of FEATURE_FRONTEND_MEL_BANDS is accepted, such as [1, frames, bands]
+ * or [1, frames, bands, 1]. int8 and float32 inputs are supported. The
+ * score is the last element of the first output, which is the wake word
+ * class of a [background, wake word] softmax or a single sigmoid.
+ *
+ * Only builtin TFLite operators are registered. Models optimised with the
+ * xcore xformer use xcore custom operators and are not supported.
+ */
+
+/**
+ * Loads the model and allocates its tensors from arena. The model must
+ * stay valid and unchanged while the interpreter is in use.
+ *
+ * \returns 0 on success, or -1 if the model is not a supported wake word
+ *          model or does not fit in the arena.
+ */
+int ww_inference_init(const uint8_t *model, uint8_t *arena, size_t arena_size);
+
+/**
+ * \returns the feature frames in the model input window.
+ */
+int ww_inference_frames(void);
+
+/**
+ * \returns the arena bytes used by the model, after ww_inference_init().
+ */
+size_t ww_inference_arena_used(void);
+
+/**
+ * Moves the input window along by one feature frame and writes features,
+ * FEATURE_FRONTEND_MEL_BANDS values, as the newest frame.
+ */
+void ww_inference_push(const float *features);
+
+/**
+ * Runs the model on the current input window.
+ *
+ * \returns 0 with the wake word score from 0 to 1 in score, or -1 if the
+ *          model failed to run.
+ */
+int ww_inference_invoke(float *score);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WW_INFERENCE_H_ */
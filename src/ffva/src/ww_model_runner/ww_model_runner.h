@@ -8,10 +8,14 @@
 
 void ww_task_create(unsigned priority);
 
-void ww_audio_send(rtos_intertile_t *intertile_ctx,
-                   size_t frame_count,
-                   int32_t (*processed_audio_frame)[2]);
-
 void model_runner_manager(void *args);
 
+/**
+ * Called by the model runner after each run of the wake word model, with
+ * the score from 0 to 1. detected is set on the run that crosses
+ * appconfWW_DETECT_THRESHOLD, then not again for
+ * appconfWW_DETECT_HOLDOFF_HOPS. Implemented by the application.
+ */
+void ww_model_runner_result(float score, int detected);
+
 #endif /* WW_MODEL_RUNNER_H_ */